@@ -1,27 +1,71 @@
 #ifndef BTCCW_NODE_AUDIO_IO_HPP
 #define BTCCW_NODE_AUDIO_IO_HPP
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <portaudio.h>
 
+#include "ring_buffer.hpp"
+#include "tone_synth.hpp"
+
 namespace btccw::node {
 
+/// How the input stream delivers audio.
+enum class CaptureMode {
+    Blocking,   // Pa_ReadStream into a caller buffer; stream stopped between captures
+    Callback,   // PortAudio callback -> lock-free ring -> consumer; stream runs continuously
+};
+
 /// Configuration for audio I/O.
 struct AudioConfig {
     double sample_rate   = 44100.0;
     double tone_freq_hz  = 750.0;    // CW tone frequency
     int    wpm           = 20;       // Words per minute
+    double rise_time_ms  = 5.0;      // raised-cosine key edge (0 = hard keying)
     int    output_device = -1;       // -1 = default
     int    input_device  = -1;       // -1 = default
+
+    CaptureMode capture_mode = CaptureMode::Callback;
+    std::size_t ring_frames  = 1u << 18;  // capture ring capacity (~5.9 s at 44.1 kHz)
+};
+
+/// Capture ring counters (callback mode), for sizing ring_frames.
+struct CaptureStats {
+    uint64_t    overruns        = 0;  // callbacks that found the ring full
+    uint64_t    dropped_frames  = 0;  // frames lost to overruns
+    uint64_t    stalls          = 0;  // times no audio arrived for kStallChunks chunk periods
+    uint64_t    input_overflows = 0;  // overflows reported by PortAudio itself
+    std::size_t high_water      = 0;  // largest ring fill seen, in frames
+    std::size_t capacity        = 0;  // ring capacity, in frames
+};
+
+/// Where a transmission stands. Times are in audio, counted from what the
+/// output callback has rendered (ahead of the speaker by the output latency).
+struct TransmitProgress {
+    bool        active      = false;  // a transmission is playing
+    std::size_t units_sent  = 0;      // timing units rendered so far
+    std::size_t units_total = 0;
+    double      elapsed_s   = 0.0;
+    double      remaining_s = 0.0;
+    uint64_t    underflows  = 0;      // output underflows reported by PortAudio
 };
 
 /// PortAudio wrapper for transmitting and receiving Morse audio.
 class AudioIO {
 public:
+    /// Receives captured samples chunk by chunk (mono, float).
+    using SampleCallback = std::function<void(const float*, std::size_t)>;
+
+    /// Receives transmit progress while a blocking transmit() waits.
+    using ProgressCallback = std::function<void(const TransmitProgress&)>;
+
     AudioIO();
     ~AudioIO();
 
@@ -34,14 +78,66 @@ public:
     /// Shut down PortAudio.
     void close();
 
-    /// Play a Morse timing array as audio through the output device.
-    /// Each element is +1 (tone ON) or -1 (silence) for one timing unit.
-    bool transmit(const std::vector<int8_t>& timing);
+    /// Play a Morse timing array as audio through the output device and
+    /// wait for it to finish. Each element is +1 (tone ON) or -1 (silence)
+    /// for one timing unit. `on_progress`, if set, is called every
+    /// kProgressInterval while it plays.
+    bool transmit(const std::vector<int8_t>& timing,
+                  const ProgressCallback& on_progress = {});
+
+    /// Start playing `timing` and return at once. The output callback
+    /// renders it block by block, so the first samples leave within one
+    /// buffer period and memory does not grow with its length. Returns
+    /// false if a transmission is already playing.
+    bool start_transmit(std::vector<int8_t> timing);
+
+    /// Block until the transmission started by start_transmit() has played
+    /// out, reporting progress as transmit() does. False if the stream failed.
+    bool wait_transmit(const ProgressCallback& on_progress = {});
+
+    /// Cut the current transmission short.
+    void stop_transmit();
+
+    /// Snapshot of the current (or last) transmission's progress.
+    TransmitProgress transmit_progress() const;
+
+    /// How often a waiting transmit() polls the stream and reports progress.
+    static constexpr std::chrono::milliseconds kProgressInterval{50};
 
     /// Record audio from the input device for `duration_sec` seconds.
     /// Returns the captured PCM samples (mono, float).
     std::vector<float> capture(double duration_sec);
 
+    /// Record for `duration_sec` seconds, delivering samples to `on_samples`
+    /// in chunks of kCaptureChunkFrames as they arrive instead of returning
+    /// one buffer. Returns false if the stream could not be started or the
+    /// device stopped delivering before the duration was captured.
+    bool capture(double duration_sec, const SampleCallback& on_samples);
+
+    /// Frames per chunk delivered by the streaming capture (~23 ms at 44.1 kHz).
+    static constexpr std::size_t kCaptureChunkFrames = 1024;
+
+    /// The consumer finding the ring empty is normal: it polls faster than
+    /// audio arrives. Only a wait this many chunk periods long (~190 ms)
+    /// means the device stopped delivering, and counts as a stall.
+    static constexpr std::size_t kStallChunks = 8;
+
+    /// A stall this many times as long (~1.9 s), or the input stream going
+    /// inactive, means the device is gone (unplugged, host API error): the
+    /// capture gives up instead of waiting forever.
+    static constexpr std::size_t kDeadStalls = 10;
+
+    /// Callback mode: start a consumer thread that drains the capture ring
+    /// and hands chunks to `on_samples` until stop_capture(). Memory stays
+    /// at the ring size no matter how long it runs.
+    bool start_capture(SampleCallback on_samples);
+
+    /// Stop and join the consumer thread started by start_capture().
+    void stop_capture();
+
+    /// Snapshot of the capture ring counters.
+    CaptureStats capture_stats() const;
+
     /// List available audio devices and their indices.
     static void list_devices();
 
@@ -53,9 +149,50 @@ private:
     PaStream*   input_stream_  = nullptr;
     AudioConfig cfg_;
     bool        initialized_   = false;
-
-    /// Render the timing array into a PCM buffer of sine-wave samples.
-    std::vector<float> render_tone(const std::vector<int8_t>& timing) const;
+    std::unique_ptr<ToneSynth> synth_;   // element templates for cfg_
+
+    // --- callback transmit ---
+    // tx_timing_ and tx_cursor_ belong to the output callback while it
+    // runs; other threads only read the atomics.
+    std::vector<int8_t>    tx_timing_;
+    ToneSynth::Cursor      tx_cursor_;
+    uint64_t               tx_total_   = 0;      // samples in tx_timing_
+    std::atomic<bool>      tx_running_{false};
+    std::atomic<uint64_t>  tx_samples_{0};
+    std::atomic<uint64_t>  output_underflows_{0};
+
+    // --- callback capture ---
+    std::unique_ptr<SpscRingBuffer<float>> ring_;
+    bool                   input_running_ = false;
+    std::thread            consumer_;
+    std::atomic<bool>      consuming_{false};
+    std::atomic<uint64_t>  overruns_{0};
+    std::atomic<uint64_t>  dropped_frames_{0};
+    std::atomic<uint64_t>  stalls_{0};
+    std::atomic<uint64_t>  input_overflows_{0};
+    std::atomic<std::size_t> high_water_{0};
+
+    /// PortAudio input callback: copy into ring_, never block.
+    static int input_callback(const void* input, void* output,
+                              unsigned long frames,
+                              const PaStreamCallbackTimeInfo* time_info,
+                              PaStreamCallbackFlags status, void* user_data);
+
+    /// PortAudio output callback: render the next block of tx_timing_.
+    static int output_callback(const void* input, void* output,
+                               unsigned long frames,
+                               const PaStreamCallbackTimeInfo* time_info,
+                               PaStreamCallbackFlags status, void* user_data);
+
+    /// Start the callback-mode input stream if it is not already running.
+    bool ensure_input_running();
+
+    /// Pull up to `max_frames` from the ring into `on_samples`, sleeping
+    /// briefly when it is empty. Stops early when `keep_going` turns false
+    /// or the device stops delivering (see kDeadStalls). Returns the number
+    /// of frames delivered.
+    uint64_t drain(uint64_t max_frames, const SampleCallback& on_samples,
+                   const std::atomic<bool>& keep_going);
 };
 
 } // namespace btccw::node
@@ -0,0 +1,33 @@
+#ifndef BTCCW_NODE_BASE43_CODEC_HPP
+#define BTCCW_NODE_BASE43_CODEC_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace btccw::node {
+
+/// Base43 conversion for whole transactions, output byte-identical to
+/// btccw::Base43 (leading zero bytes as leading '0's, the rest as one big
+/// number).
+///
+/// The core codec carries one byte or digit at a time across the whole
+/// number, which is quadratic with a large constant. Here the number is
+/// held in 32-bit limbs, five Base43 digits or four bytes each, and the
+/// source is split in halves recursively: value = high * radix^m + low,
+/// with the powers squared once and Karatsuba products, so a long payload
+/// costs about n^1.6 limb operations instead of n^2 byte steps.
+class Base43Codec {
+public:
+    /// Base43 text for `bytes`.
+    static std::string encode(const std::vector<uint8_t>& bytes);
+
+    /// Bytes for Base43 `text`; empty if a character is outside the
+    /// alphabet (or `text` is empty).
+    static std::vector<uint8_t> decode(std::string_view text);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_BASE43_CODEC_HPP
@@ -0,0 +1,75 @@
+#ifndef BTCCW_NODE_BOUNDED_QUEUE_HPP
+#define BTCCW_NODE_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace btccw::node {
+
+/// Fixed-capacity multi-producer / multi-consumer queue between worker
+/// threads.
+///
+/// Producers never wait: try_push() fails when the queue is full, so a slow
+/// consumer costs dropped items rather than a stalled producer. Consumers
+/// block in pop() until an item arrives or the queue is closed. Unlike
+/// SpscRingBuffer this locks, so it is not for the audio callback.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /// Append `item` unless the queue is full or closed.
+    bool try_push(T item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || items_.size() >= capacity_) return false;
+            items_.push_back(std::move(item));
+        }
+        ready_.notify_one();
+        return true;
+    }
+
+    /// Take the oldest item, waiting for one. Returns false once the queue
+    /// is closed and empty; items queued before close() are still handed out.
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        out = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+
+    /// Refuse further pushes and wake every waiting consumer.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    std::size_t             capacity_;
+    mutable std::mutex      mutex_;
+    std::condition_variable ready_;
+    std::deque<T>           items_;
+    bool                    closed_ = false;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_BOUNDED_QUEUE_HPP
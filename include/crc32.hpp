@@ -0,0 +1,62 @@
+#ifndef BTCCW_NODE_CRC32_HPP
+#define BTCCW_NODE_CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace btccw::node {
+
+/// CRC-32 (IEEE 802.3, reflected, as btccw::Checksum::crc32()) with
+/// runtime CPU dispatch.
+///
+/// Values are the finished CRC (initial and final inversion applied), so
+/// update() continues a CRC from where an earlier call left it and
+/// combine() joins two of them:
+///
+///   compute(a + b) == update(compute(a), b) == combine(compute(a), compute(b), b.size())
+///
+/// Long inputs are folded 64 bytes per step with carry-less multiplies
+/// (PCLMULQDQ) where the CPU has them, otherwise run slicing-by-8: eight
+/// table lookups per eight bytes instead of one per byte.
+class Crc32 {
+public:
+    static uint32_t compute(std::string_view data) { return update(0, data); }
+
+    /// CRC of the earlier data followed by `data`, from the earlier CRC.
+    static uint32_t update(uint32_t crc, std::string_view data) {
+        return update(crc, data.data(), data.size());
+    }
+    static uint32_t update(uint32_t crc, const void* data, std::size_t len);
+
+    /// CRC of a + b from the CRCs of a and b and the length of b, in
+    /// O(log len_b) without touching the data.
+    static uint32_t combine(uint32_t crc_a, uint32_t crc_b, std::size_t len_b);
+
+    /// combine() for a fixed len_b, prepared once: each call is then a
+    /// single 32-bit carry-less product.
+    class Combiner {
+    public:
+        explicit Combiner(std::size_t len_b = 0);
+        uint32_t operator()(uint32_t crc_a, uint32_t crc_b) const;
+
+    private:
+        uint32_t shift_;   // x^(8 * len_b) mod P
+    };
+
+    /// Portable references, always available.
+    static uint32_t update_bytewise(uint32_t crc, const void* data, std::size_t len);
+    static uint32_t update_slice8(uint32_t crc, const void* data, std::size_t len);
+
+    /// Name of the selected implementation: "pclmul" or "slice8".
+    static const char* name();
+
+    /// Make update() use the named implementation if this CPU has it, for
+    /// tests and benchmarks; false if not. Not safe while other threads
+    /// are hashing.
+    static bool force(std::string_view name);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_CRC32_HPP
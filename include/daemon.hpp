@@ -0,0 +1,83 @@
+#ifndef BTCCW_NODE_DAEMON_HPP
+#define BTCCW_NODE_DAEMON_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "bounded_queue.hpp"
+#include "node_engine.hpp"
+
+namespace btccw::node {
+
+/// Tuning for unattended operation.
+struct DaemonConfig {
+    std::size_t queue_depth = 64;   // decoded transactions awaiting broadcast
+};
+
+/// Daemon counters, for periodic status lines.
+struct DaemonStats {
+    uint64_t    frames       = 0;   // CRC-valid frames heard
+    uint64_t    transactions = 0;   // whole transactions decoded
+    uint64_t    dropped      = 0;   // transactions lost to a full queue
+    uint64_t    broadcast    = 0;   // accepted by the gateway
+    uint64_t    failed       = 0;   // rejected by the gateway
+    std::size_t queued       = 0;   // waiting for the broadcast worker now
+};
+
+/// Continuous receive -> decode -> broadcast.
+///
+///   PortAudio callback --SpscRingBuffer--> decode thread
+///                      --BoundedQueue----> broadcast worker --> Gateway
+///
+/// Each stage runs on its own thread, and the only waiting is downstream.
+/// The audio callback never blocks (a full ring counts an overrun), and the
+/// decode thread never waits for the gateway (a full queue drops the
+/// transaction and counts it). A slow or unreachable gateway therefore costs
+/// queued transactions, never audio.
+class Daemon {
+public:
+    /// @param engine  Initialised in callback capture mode; must outlive
+    ///                this object.
+    explicit Daemon(NodeEngine& engine, const DaemonConfig& cfg = {});
+    ~Daemon();
+
+    Daemon(const Daemon&) = delete;
+    Daemon& operator=(const Daemon&) = delete;
+
+    /// Start the broadcast worker and continuous capture.
+    bool start();
+
+    /// Stop capture, flush the decoder, then let the worker broadcast what
+    /// is already queued and join it. Safe to call more than once.
+    void stop();
+
+    bool running() const noexcept { return running_; }
+
+    DaemonStats stats() const;
+
+private:
+    NodeEngine&              engine_;
+    DaemonConfig             cfg_;
+    BoundedQueue<std::string> queue_;
+    std::thread              worker_;
+    bool                     running_ = false;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> transactions_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> broadcast_{0};
+    std::atomic<uint64_t> failed_{0};
+
+    /// Decode thread: one frame from the streaming decoder.
+    void on_frame(const DecodeResult& result);
+
+    /// Broadcast worker loop; returns when the queue is closed and empty.
+    void broadcast_loop();
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_DAEMON_HPP
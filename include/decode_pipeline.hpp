@@ -6,8 +6,11 @@
 #include <vector>
 
 #include "deframer.hpp"
+#include "fragmenter.hpp"
 #include "goertzel.hpp"
+#include "goertzel_bank.hpp"
 #include "morse_decoder.hpp"
+#include "soft_morse_decoder.hpp"
 
 namespace btccw::node {
 
@@ -28,23 +31,71 @@ struct DecodeResult {
     bool        success       = false;
 
     // Intermediate values (populated as stages complete).
-    std::vector<bool> tone_bits;
+    ToneBits          tone_bits;
     std::string       morse_text;
     std::string       base43_payload;
     std::vector<uint8_t> raw_bytes;
     std::string       hex_string;
 
     std::string error;
+
+    double tone_freq_hz = 0.0;   // channel the frame was heard on (decode_multi)
+    double wpm          = 0.0;   // sender speed the Morse stage decoded at
+    bool   soft_decision = false; // recovered by SoftMorseDecoder
+    std::size_t repaired = 0;     // unknown symbols filled in by the CRC search
+
+    // Set (count > 0) when the frame carries one fragment of a larger
+    // transaction instead of a whole one; success stays false.
+    Fragment fragment{};
+};
+
+/// Receive-side tuning. Defaults match the single 750 Hz channel.
+struct DecodeConfig {
+    double      sample_rate = 44100.0;
+    double      tone_freq   = 750.0;
+    int         wpm         = 20;
+    std::size_t block_size  = 882;
+    double      threshold   = 0.0;    // Goertzel threshold (0 = auto)
+    std::size_t hop_size    = 0;      // samples per decision; 0 = block_size
+
+    // Median estimator behind the auto-threshold (threshold == 0).
+    ThresholdMode threshold_mode = ThresholdMode::Histogram;
+
+    // Span of the noise floor / peak tracker in ThresholdMode::Adaptive.
+    double      noise_window_s = 5.0;
+
+    // Estimate the sender's speed; `wpm` is then only the starting guess.
+    bool        auto_wpm = true;
+
+    // Soft-decision retry when decode() finds no valid frame: distinct
+    // texts checked against the CRC (0 = hard decisions only), and the
+    // search beam width.
+    std::size_t soft_candidates = SoftMorseDecoder::kCandidates;
+    std::size_t soft_beam       = SoftMorseDecoder::kBeamWidth;
+
+    // Filter-bank channels for decode_multi(); empty = tone_freq only.
+    std::vector<double> channel_freqs;
+
+    // Limits on fragmented transactions being collected (NodeEngine).
+    ReassemblyConfig reassembly;
 };
 
 /// Full receive/decode pipeline: PCM → hex transaction.
 ///
 /// Stages:
-///   1. Goertzel detect → vector<bool>
+///   1. Goertzel detect → ToneBits (packed tone decisions)
 ///   2. Morse decode → text string
-///   3. Deframe → Base43 payload (CRC verified)
+///   3. Deframe → Base43 payload (CRC verified; Deframer::scan() finds the
+///      frame anywhere in the text)
 ///   4. Base43::decode() → raw bytes
 ///   5. Transaction::bytes_to_hex() + validate() → hex string
+///
+/// A frame carrying one fragment of a larger transaction stops at stage 4
+/// or 5 with DecodeResult::fragment set; the caller reassembles.
+///
+/// If that yields no valid transaction, decode() runs SoftMorseDecoder on
+/// the stage 1 magnitudes and passes its candidate texts through stages
+/// 3-5; the first the CRC accepts wins.
 class DecodePipeline {
 public:
     /// Construct the pipeline with audio parameters.
@@ -56,12 +107,57 @@ public:
     DecodePipeline(double sample_rate, double tone_freq, int wpm,
                    std::size_t block_size = 882, double threshold = 0.0);
 
+    /// Construct the pipeline from a full receive configuration.
+    explicit DecodePipeline(const DecodeConfig& cfg);
+
     /// Run the full pipeline on a PCM buffer.
     DecodeResult decode(const std::vector<float>& pcm) const;
 
+    /// Run every filter-bank channel through its own Morse decoder and
+    /// deframer in one pass over `pcm`. Returns one result per distinct
+    /// CRC-valid frame (several stations, or several transmissions on one
+    /// channel, yield several results). Falls back to the single detector
+    /// when no channels are configured.
+    std::vector<DecodeResult> decode_multi(const std::vector<float>& pcm) const;
+
+    /// Run stages 3-5 (deframe, Base43 decode, validate) on decoded text.
+    /// Used by decode() and by StreamingDecoder once a frame is complete.
+    /// `erasures` (positions in `morse_text`) are repaired against the CRC.
+    DecodeResult decode_frame(const std::string& morse_text,
+                              const std::vector<Erasure>& erasures = {}) const;
+
+    /// Run stages 3-5 on every frame Deframer::scan() finds in `text`, in
+    /// order. Noise around and between the frames is skipped.
+    std::vector<DecodeResult> decode_frames(const std::string& text,
+                                            const std::vector<Erasure>& erasures = {}) const;
+
+    /// Run stages 4-5 (Base43 decode, validate) on a CRC-checked payload,
+    /// e.g. one reassembled from fragments. A payload that is not a valid
+    /// transaction but parses as a fragment fills DecodeResult::fragment.
+    DecodeResult decode_payload(const std::string& base43_payload) const;
+
+    /// Feed a fragment result to `reassembler`. When it completes its
+    /// transaction, `result` becomes the decode of the whole payload.
+    void reassemble(Reassembler& reassembler, DecodeResult& result) const;
+
+    /// Words per minute for a Morse unit of `unit` decisions.
+    double unit_to_wpm(double unit) const noexcept;
+
+    const GoertzelDetector& detector() const noexcept { return detector_; }
+    const MorseDecoder& morse_decoder() const noexcept { return morse_decoder_; }
+    const SoftMorseDecoder& soft_decoder() const noexcept { return soft_decoder_; }
+
 private:
+    DecodeConfig     cfg_;
     GoertzelDetector detector_;
+    GoertzelBank     bank_;
     MorseDecoder     morse_decoder_;
+    SoftMorseDecoder soft_decoder_;
+
+    /// Replace `result` with the first soft-decision candidate that decodes
+    /// to a valid transaction. Returns false if none does.
+    bool soft_decode(const std::vector<double>& mags, double unit,
+                     DecodeResult& result) const;
 };
 
 } // namespace btccw::node
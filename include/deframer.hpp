@@ -1,7 +1,11 @@
 #ifndef BTCCW_NODE_DEFRAMER_HPP
 #define BTCCW_NODE_DEFRAMER_HPP
 
+#include <cstddef>
 #include <string>
+#include <vector>
+
+#include "morse_decoder.hpp"
 
 namespace btccw::node {
 
@@ -10,6 +14,14 @@ struct DeframeResult {
     bool        valid   = false;
     std::string payload;
     std::string error;
+    std::size_t repaired = 0;   // erasures filled in by the CRC search
+};
+
+/// A frame found by Deframer::scan().
+struct SyncedFrame {
+    std::size_t   begin = 0;   // first character of the (possibly damaged) preamble
+    std::size_t   end   = 0;   // one past the " AR"
+    DeframeResult result;      // always valid
 };
 
 /// Inverse of Checksum::frame().
@@ -20,6 +32,41 @@ class Deframer {
 public:
     /// Strip framing, extract payload, and verify CRC.
     static DeframeResult deframe(const std::string& text);
+
+    /// As deframe(), also accepting version 2 (FecFramer) frames, with the
+    /// characters at `erasures` unknown. If a version 1 text
+    /// as received fails, every combination of the erasures' candidates is
+    /// tried against the CRC, continuing one running CRC-32 from the last
+    /// erasure instead of rehashing the payload. The first combination the
+    /// CRC accepts is returned. The CRC's four Base43 characters hold about
+    /// 22 bits, so the search is capped at kMaxRepairTries combinations of
+    /// at most kMaxRepairErasures erasures to keep false accepts near 0.1%;
+    /// transaction validation downstream catches most of the rest.
+    static DeframeResult deframe(const std::string& text,
+                                 const std::vector<Erasure>& erasures);
+
+    /// Find every valid frame in continuous decoded text: leading noise,
+    /// back-to-back transmissions and trailing garbage are skipped.
+    ///
+    /// One pass over the text. A preamble is "KKK " with at most one of the
+    /// K's wrong or missing. Each keeps a running CRC-32 of what follows it,
+    /// and every " AR" checks the last four characters against it, so no
+    /// span is rehashed. Only the kMaxOpenPreambles latest preambles stay
+    /// open, which bounds the work per character; frames do not overlap, so
+    /// a valid one closes them all. Version 2 headers announce their
+    /// length, so those frames are checked once, at their announced end.
+    /// Spans holding erasures go through deframe(), but each " AR" runs at
+    /// most one repair search, for the latest preamble whose span holds
+    /// erasures. After kMaxScanRepairs failed searches the rest of the text
+    /// is checked as read, so noise full of erasures stays linear.
+    static std::vector<SyncedFrame> scan(const std::string& text,
+                                         const std::vector<Erasure>& erasures = {});
+
+    static constexpr std::size_t kMaxOpenPreambles = 4;
+
+    static constexpr std::size_t kMaxRepairErasures = 3;
+    static constexpr std::size_t kMaxRepairTries    = 4096;
+    static constexpr std::size_t kMaxScanRepairs    = 64;   // failed searches per scan()
 };
 
 } // namespace btccw::node
@@ -0,0 +1,93 @@
+#ifndef BTCCW_NODE_FEC_FRAMER_HPP
+#define BTCCW_NODE_FEC_FRAMER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "deframer.hpp"
+#include "morse_decoder.hpp"
+
+namespace btccw::node {
+
+/// Transmit framing options.
+struct FrameConfig {
+    /// Reed-Solomon parity symbols per codeword; 0 = classic CRC-only frame.
+    /// Each codeword corrects parity/2 bad characters, or `parity` erased
+    /// ones (unknown Morse patterns), or a mix (2 * errors + erasures).
+    std::size_t fec_parity = 0;
+
+    /// Split payloads longer than this into separately framed fragments
+    /// (Fragmenter); 0 = always send one frame.
+    std::size_t fragment_chars = 0;
+};
+
+/// Version 2 frame: Reed-Solomon over Base43 symbols, interleaved.
+///
+/// Frame format:
+///   "KKK " + header(9) + interleaved codewords + " AR"
+///
+/// Base43 characters are the elements of GF(43) (43 is prime, so the field
+/// is just arithmetic mod 43), in alphabet order. The header is one
+/// codeword of 5 data symbols (version, parity, 3-digit payload length) and
+/// 4 parity symbols. The body is the payload plus its usual 4-character CRC,
+/// cut into shortened codewords of at most kMaxCodeword symbols, sent
+/// column by column: symbol 0 of every codeword, then symbol 1, and so on.
+/// A fade that wipes out b consecutive characters therefore costs each of
+/// the m codewords only about b / m of them.
+///
+/// The CRC is kept inside the protected data to catch miscorrections. A
+/// version 1 receiver reads the last four parity characters as its CRC and
+/// rejects the frame there.
+class FecFramer {
+public:
+    static constexpr std::size_t kVersion        = 2;
+    static constexpr std::size_t kMaxCodeword    = 42;   // GF(43) has 42 nonzero elements
+    static constexpr std::size_t kHeaderData     = 5;
+    static constexpr std::size_t kHeaderParity   = 4;
+    static constexpr std::size_t kMinParity      = 2;
+    static constexpr std::size_t kMaxParity      = 20;
+    static constexpr std::size_t kMaxPayload     = 43 * 43 * 43 - 1;
+
+    /// Body characters that may be missing (collapsed double word gaps,
+    /// merged characters) and still be searched for.
+    static constexpr std::size_t kMaxMissing = 2;
+
+    /// Frame a Base43 payload with `parity` symbols per codeword (clamped to
+    /// [kMinParity, kMaxParity]). Returns empty if the payload is too long
+    /// or has a character outside the Base43 alphabet.
+    static std::string frame(const std::string& payload, std::size_t parity);
+
+    /// True if `text` starts with "KKK " and a decodable version 2 header.
+    static bool is_fec_frame(const std::string& text);
+
+    /// Characters in the whole frame ("KKK " to " AR") announced by the
+    /// version 2 header at the start of `text`, or 0 if it has none.
+    /// Up to kMaxMissing fewer may arrive.
+    static std::size_t frame_length(const std::string& text);
+
+    /// Correct and strip a version 2 frame. `erasures` (positions in
+    /// `text`) are decoded as erasures, which cost half an error each.
+    /// DeframeResult::repaired counts the corrected characters.
+    static DeframeResult deframe(const std::string& text,
+                                 const std::vector<Erasure>& erasures = {});
+
+    /// Base43 alphabet index of `c`, or -1.
+    static int symbol_of(char c) noexcept;
+    static char char_of(int symbol) noexcept;
+
+    /// Systematic encode: append `parity` check symbols to `data`.
+    /// data.size() + parity must not exceed kMaxCodeword.
+    static void rs_encode(std::vector<uint8_t>& data, std::size_t parity);
+
+    /// Correct `codeword` (data then parity) in place. `erased` lists
+    /// indices whose values are unknown. Returns the number of symbols
+    /// changed, or -1 if the codeword is beyond repair.
+    static int rs_decode(std::vector<uint8_t>& codeword, std::size_t parity,
+                         const std::vector<std::size_t>& erased = {});
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_FEC_FRAMER_HPP
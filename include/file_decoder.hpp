@@ -0,0 +1,131 @@
+#ifndef BTCCW_NODE_FILE_DECODER_HPP
+#define BTCCW_NODE_FILE_DECODER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "decode_pipeline.hpp"
+#include "pcm_file.hpp"
+
+namespace btccw::node {
+
+/// Settings for decoding recordings.
+struct FileDecodeConfig {
+    // sample_rate and block_size follow each file. A recording is streamed,
+    // so the threshold follows the noise tracker: a running median drifts
+    // with the keying over a long file.
+    DecodeConfig decode = [] {
+        DecodeConfig cfg;
+        cfg.threshold_mode = ThresholdMode::Adaptive;
+        return cfg;
+    }();
+    PcmFormat    raw;                    // layout of headerless files
+    std::size_t  threads      = 0;       // worker threads; 0 = one per core
+    std::size_t  push_frames  = 4096;    // frames converted per push (timestamp resolution)
+
+    // A long recording is cut into chunks decoded in parallel. A chunk
+    // that ends with a frame still open reads on until its " AR" (or the
+    // key goes idle), so a frame is heard whole by the chunk it starts in;
+    // frames seen twice where chunks overlap are reported once.
+    double       max_frame_s  = 0.0;     // longest frame on air (how far a chunk reads on);
+                                         // 0 = the frame bound at the speed heard
+    double       chunk_s      = 0.0;     // chunk length; 0 = four per thread, no shorter
+                                         // than 16 seam margins
+};
+
+/// One frame recovered from a recording.
+struct FileFrame {
+    double       offset_s = 0.0;   // from the start of the file to the end of its " AR"
+    DecodeResult result;           // fragments that complete a transaction arrive whole
+};
+
+/// Everything recovered from one recording.
+struct FileDecodeResult {
+    std::string            path;
+    bool                   opened     = false;
+    std::string            error;         // why the file could not be read
+    double                 duration_s = 0.0;
+    std::size_t            chunks     = 0;   // pieces decoded in parallel
+    std::vector<FileFrame> frames;
+};
+
+/// Decodes recorded audio: WAV (16-bit PCM or float32) or raw PCM.
+///
+/// Each file is memory-mapped and cut into chunks on Goertzel block
+/// boundaries, so every chunk makes the same tone decisions the whole file
+/// would. The chunks of all files go to one WorkStealingPool; each is
+/// streamed through its own StreamingDecoder (detection, Morse decode and
+/// frame search) a push at a time, so memory does not grow with the
+/// recording's length. A chunk keeps the frames that end inside it, give
+/// or take a seam margin, and those still open where it ends, which it
+/// reads on to finish. Frames found by two neighbours are merged.
+/// Fragmented transactions are then reassembled within each file, in order.
+class FileDecoder {
+public:
+    /// Called once per file as it finishes, from a worker thread; calls
+    /// never overlap.
+    using FileCallback = std::function<void(const FileDecodeResult&)>;
+
+    explicit FileDecoder(const FileDecodeConfig& cfg = {});
+
+    /// Decode one file, its chunks spread over the threads.
+    FileDecodeResult decode(const std::string& path) const;
+
+    /// Decode `paths` concurrently. Results are in the order of `paths`.
+    std::vector<FileDecodeResult> decode_all(const std::vector<std::string>& paths,
+                                             const FileCallback& on_file = {}) const;
+
+    /// Expand directories in `args` to the recordings directly inside them
+    /// (.wav, .raw, .pcm, .s16, .f32; sorted by name). Other arguments are
+    /// kept as given.
+    static std::vector<std::string> expand(const std::vector<std::string>& args);
+
+    const FileDecodeConfig& config() const noexcept { return cfg_; }
+
+    /// Longest frame `rx` can receive, in characters: a whole transaction
+    /// (ReassemblyConfig::max_chars of Base43) under the most FEC parity,
+    /// with its preamble, headers, CRC and " AR".
+    static std::size_t frame_bound_chars(const DecodeConfig& rx);
+
+    /// That frame's air time with every character the longest in Morse,
+    /// at the slowest speed `rx` follows (a kMaxSpeedRatio below wpm with
+    /// auto_wpm).
+    static double frame_bound_s(const DecodeConfig& rx);
+
+private:
+    FileDecodeConfig cfg_;
+
+    /// Part of a file decoded by one task, in frames: the decoder runs
+    /// over [read_begin, read_end) and keeps frames ending in
+    /// [keep_begin, keep_end). A frame open at read_end is read on for,
+    /// up to read_cap (tightened to the speed heard), and kept.
+    struct Span {
+        std::size_t read_begin = 0;
+        std::size_t keep_begin = 0;
+        std::size_t keep_end   = 0;
+        std::size_t read_end   = 0;
+        std::size_t read_cap   = 0;
+    };
+
+    /// The receive configuration for a file at `sample_rate`: the Goertzel
+    /// block keeps its duration.
+    DecodeConfig config_for(double sample_rate) const;
+
+    /// Cut `file` into spans of about `chunk_s` seconds.
+    std::vector<Span> plan(const PcmFile& file, const DecodeConfig& rx, double chunk_s) const;
+
+    /// Frames ending in the span, with offsets from the start of the file
+    /// (not yet reassembled).
+    std::vector<FileFrame> decode_span(const PcmFile& file, const DecodePipeline& pipeline,
+                                       const Span& span) const;
+
+    /// Seconds either side of a seam within which two chunks may both
+    /// report a frame (decoder warm-up and push granularity).
+    double seam_margin_s() const;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_FILE_DECODER_HPP
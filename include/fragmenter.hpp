@@ -0,0 +1,107 @@
+#ifndef BTCCW_NODE_FRAGMENTER_HPP
+#define BTCCW_NODE_FRAGMENTER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace btccw::node {
+
+/// One fragment of a Base43 payload, as carried in a frame.
+struct Fragment {
+    std::string tx_id;        // Fragmenter::tx_id() of the whole payload
+    std::size_t index = 0;    // 0-based
+    std::size_t count = 0;    // fragments in the transaction; 0 = not a fragment
+    std::string data;
+};
+
+/// Splits a Base43 payload into numbered fragments, each sent as its own
+/// frame (and so with its own CRC, and parity if FEC is on).
+///
+/// Fragment payload format:
+///   tx_id(4) + index(2) + count(2) + data
+///
+/// All fields are Base43 digits. The ID is the 4-character CRC of the whole
+/// payload, so a resend of some fragments carries the same ID, and the
+/// reassembled payload can be checked against it. A fragment payload never
+/// validates as a transaction; the receiver tries that first.
+class Fragmenter {
+public:
+    static constexpr std::size_t kIdLen        = 4;
+    static constexpr std::size_t kHeaderLen    = kIdLen + 4;
+    static constexpr std::size_t kMaxFragments = 43 * 43 - 1;   // largest two-digit count
+
+    /// Fragment payloads of at most `fragment_chars` data characters each,
+    /// in order. Returns empty if that would need more than kMaxFragments.
+    static std::vector<std::string> split(const std::string& payload,
+                                          std::size_t fragment_chars);
+
+    /// Parse a fragment payload. Returns false if `payload` is not one.
+    static bool parse(const std::string& payload, Fragment& out);
+
+    /// Short ID of a whole payload.
+    static std::string tx_id(const std::string& payload);
+};
+
+/// Receive-side limits for fragmented transactions.
+struct ReassemblyConfig {
+    std::size_t max_pending   = 4;        // transactions collected at once
+    std::size_t max_fragments = 256;      // fragments per transaction
+    std::size_t max_chars     = 16384;    // Base43 characters held per transaction
+    double      expiry_s      = 900.0;    // drop a partial this long after its last fragment
+};
+
+/// Where one transaction stands after a fragment arrives.
+struct ReassemblyStatus {
+    std::string tx_id;
+    std::size_t received = 0;
+    std::size_t count    = 0;
+    bool        complete = false;
+    std::string payload;      // whole Base43 payload once complete
+    std::string error;        // fragment rejected, or partial dropped
+};
+
+/// Collects fragments in any order, across any number of captures.
+///
+/// Partials live in a small table bounded by max_pending; when it is full
+/// the least recently heard transaction is dropped. Each partial holds at
+/// most max_fragments slots and max_chars characters, so memory is bounded
+/// whatever arrives. A completed transaction leaves the table.
+class Reassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Reassembler(const ReassemblyConfig& cfg = {});
+
+    /// Store `fragment`, expiring stale partials first.
+    ReassemblyStatus add(const Fragment& fragment, Clock::time_point now = Clock::now());
+
+    /// Indices not yet received for `tx_id` (empty if it is not pending).
+    std::vector<std::size_t> missing(const std::string& tx_id) const;
+
+    /// Drop partials not heard from for expiry_s. Returns the number dropped.
+    std::size_t expire(Clock::time_point now = Clock::now());
+
+    /// Transactions being collected.
+    std::size_t pending() const noexcept { return partials_.size(); }
+
+    const ReassemblyConfig& config() const noexcept { return cfg_; }
+
+private:
+    struct Partial {
+        std::string              tx_id;
+        std::vector<std::string> parts;      // one slot per index
+        std::size_t              received = 0;
+        std::size_t              chars    = 0;
+        Clock::time_point        last;
+    };
+
+    ReassemblyConfig     cfg_;
+    std::vector<Partial> partials_;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_FRAGMENTER_HPP
@@ -1,8 +1,21 @@
 #ifndef BTCCW_NODE_GATEWAY_HPP
 #define BTCCW_NODE_GATEWAY_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
+
+#include "txid_cache.hpp"
 
 namespace btccw::node {
 
@@ -12,8 +25,24 @@ enum class BroadcastBackend {
     BitcoinRPC,      // JSON-RPC to a local Bitcoin Core node
 };
 
+/// One place to broadcast through.
+struct BroadcastEndpoint {
+    BroadcastBackend backend = BroadcastBackend::MempoolSpace;
+    std::string url;         // mempool.space-style POST URL, or the node's RPC URL
+    std::string rpc_user;    // BitcoinRPC only
+    std::string rpc_pass;
+};
+
+/// How one broadcast uses several endpoints.
+enum class BroadcastPolicy {
+    Failover,   // the preferred endpoint; the next only if it fails
+    Hedged,     // as Failover, and the next also after hedge_delay_ms without an answer
+    Race,       // every healthy endpoint at once; the first txid wins
+};
+
 /// Configuration for the network gateway.
 struct GatewayConfig {
+    // The single endpoint used when `endpoints` is empty.
     BroadcastBackend backend = BroadcastBackend::MempoolSpace;
 
     // mempool.space settings
@@ -24,30 +53,220 @@ struct GatewayConfig {
     int         rpc_port = 8332;
     std::string rpc_user;
     std::string rpc_pass;
+
+    // Several endpoints, tried fastest healthy one first: by smoothed
+    // latency, with an endpoint that failed unhealthy_after times in a row
+    // set aside for unhealthy_cooldown_ms. RPC batches go to BitcoinRPC
+    // endpoints only.
+    std::vector<BroadcastEndpoint> endpoints;
+    BroadcastPolicy policy                = BroadcastPolicy::Failover;
+    long            hedge_delay_ms        = 2000;
+    int             unhealthy_after       = 3;
+    long            unhealthy_cooldown_ms = 60000;
+
+    // Transfer limits. Connections are kept alive between requests.
+    long        connect_timeout_ms = 10000;
+    long        timeout_ms         = 30000;   // whole request, per attempt
+    std::size_t max_in_flight      = 8;       // concurrent broadcasts
+    std::size_t queue_depth        = 256;     // requests waiting, retries included
+    std::size_t max_batch          = 100;     // transactions per JSON-RPC batch request
+
+    // Retry on transport errors, 5xx and 429, once every endpoint the
+    // policy allows has been tried in this attempt. The retry after attempt n
+    // waits a random time in [0, min(retry_max_ms, retry_base_ms * 2^(n-1))]
+    // ("full jitter"), so clients that failed together do not return together.
+    int         max_attempts  = 5;
+    long        retry_base_ms = 500;
+    long        retry_max_ms  = 30000;
+
+    // Recently broadcast txids, which NodeEngine answers without sending.
+    TxidCacheConfig dedupe;
+};
+
+/// Outcome of one broadcast, after any retries.
+struct BroadcastResult {
+    bool        success     = false;
+    std::string txid;
+    std::string error;
+    long        http_status = 0;     // of the last attempt (0 = no response)
+    std::string endpoint;            // URL that gave this answer
+    bool        cached      = false; // already broadcast: answered locally, not sent
+    int         attempts    = 0;     // requests sent, over all endpoints
+    double      latency_s   = 0.0;   // submission to completion
+};
+
+/// Per-endpoint counters, in configuration order.
+struct EndpointStats {
+    std::string url;
+    uint64_t    requests  = 0;
+    uint64_t    answered  = 0;     // accepted or rejected the transactions
+    uint64_t    errors    = 0;     // transport errors, 5xx and 429
+    uint64_t    cancelled = 0;     // abandoned when another endpoint answered first
+    double      latency_s = 0.0;   // smoothed time to answer
+    bool        healthy   = true;  // fewer than unhealthy_after errors in a row
+};
+
+/// Gateway counters, for monitoring queue depth and latency.
+struct GatewayStats {
+    uint64_t    submitted   = 0;
+    uint64_t    succeeded   = 0;
+    uint64_t    failed      = 0;     // gave up, including rejected at a full queue
+    uint64_t    retries     = 0;     // attempts after the first
+    std::size_t queued      = 0;     // waiting for a slot or a retry, now
+    std::size_t in_flight   = 0;     // transfers running, now
+    std::size_t high_water  = 0;     // largest `queued` seen
+    double      mean_latency_s = 0.0;   // over completed broadcasts
+    double      max_latency_s  = 0.0;
+    std::vector<EndpointStats> endpoints;
 };
 
 /// HTTP/RPC gateway for broadcasting raw transactions to the Bitcoin network.
+///
+/// One worker thread drives every transfer through a curl multi handle, so
+/// connections (and TLS sessions) stay open and are reused between
+/// broadcasts, and up to max_in_flight run at once. Submissions queue
+/// without blocking the caller; a full queue fails at once.
+///
+/// With several endpoints, each broadcast goes to the fastest healthy one
+/// first and, per the policy, to others as well; the first txid wins and
+/// the requests still running for it are cancelled. A rejection is held
+/// back while another endpoint may still accept.
 class Gateway {
 public:
+    /// Receives the outcome on the gateway's worker thread; must not block.
+    using BroadcastCallback = std::function<void(const BroadcastResult&)>;
+
+    /// Receives one outcome per transaction, in submission order.
+    using BatchCallback = std::function<void(const std::vector<BroadcastResult>&)>;
+
     Gateway();
     ~Gateway();
 
-    /// Initialise libcurl and store config.
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    /// Initialise libcurl, store config and start the worker.
     bool open(const GatewayConfig& cfg);
 
-    /// Clean up.
+    /// Stop the worker. Broadcasts still queued or in flight fail with
+    /// "gateway closed".
     void close();
 
-    /// Broadcast a raw hex transaction.
+    /// Broadcast a raw hex transaction and wait for the outcome.
     /// Returns the txid on success, or an empty string on failure.
     std::string broadcast(std::string_view raw_tx_hex);
 
+    /// Queue a broadcast; `done` is called once with its outcome (on the
+    /// caller's thread if it is rejected outright).
+    void broadcast_async(std::string raw_tx_hex, BroadcastCallback done);
+
+    /// Queue a broadcast and return a future for its outcome.
+    std::future<BroadcastResult> broadcast_async(std::string raw_tx_hex);
+
+    /// Broadcast several transactions and wait for all of them. Against
+    /// Bitcoin Core they go as JSON-RPC batch arrays of up to max_batch
+    /// calls, one round trip each; against mempool.space as separate
+    /// requests in parallel. Each transaction gets its own outcome.
+    std::vector<BroadcastResult> broadcast_batch(const std::vector<std::string_view>& raw_txs);
+
+    /// As broadcast_batch(), without waiting.
+    void broadcast_batch_async(std::vector<std::string> raw_txs, BatchCallback done);
+
+    GatewayStats stats() const;
+
 private:
+    using Clock = std::chrono::steady_clock;
+    struct Job;
+    struct Transfer;
+
+    /// An endpoint's health, as the worker sees it.
+    struct Endpoint {
+        BroadcastEndpoint cfg;
+        double            latency_s = 0.0;   // 0 until measured: tried first
+        int               errors_in_row = 0;
+        Clock::time_point sidelined_until;
+    };
+
     GatewayConfig cfg_;
     bool          initialized_ = false;
+    bool          has_rpc_     = false;    // batches possible
+
+    void*         multi_ = nullptr;        // CURLM*
+    std::vector<void*> idle_handles_;      // CURL*, reset and ready for reuse
+    std::thread   worker_;
+
+    // Shared with submitters; everything below it is the worker's alone.
+    mutable std::mutex               mutex_;
+    std::deque<std::unique_ptr<Job>> incoming_;
+    std::size_t                      retry_waiting_ = 0;   // retrying_.size()
+    bool                             stopping_ = false;
+    GatewayStats                     stats_;
+    double                           latency_sum_s_ = 0.0;
+
+    std::vector<Endpoint>                  endpoints_;
+    std::vector<std::unique_ptr<Job>>      active_;      // attempt under way
+    std::vector<std::unique_ptr<Transfer>> in_flight_;   // requests of active_ jobs
+    std::vector<std::unique_ptr<Job>>      retrying_;    // waiting for their `due`
+    std::minstd_rand                       rng_;
+
+    /// Queue one request for `txs`; fails it at once if the queue is full.
+    void submit(std::vector<std::string> txs, BatchCallback done);
+
+    /// Worker loop: start due jobs, pump transfers, settle finished ones.
+    void run();
+
+    /// Start `job`'s next attempt: order the endpoints and send to as
+    /// many as the policy starts with.
+    void begin(std::unique_ptr<Job> job);
+
+    /// Send `job` to the next endpoint in its order on a pooled handle.
+    /// Returns false when none is left to try.
+    bool launch(Job& job);
+
+    /// Endpoints for a job, preferred first; `healthy` of them lead.
+    std::vector<std::size_t> preference(bool batch, std::size_t& healthy) const;
+
+    /// Return the transfer's handle to the pool.
+    void release(Transfer& transfer);
+
+    /// Classify a finished transfer: complete its job, wait for the
+    /// job's other transfers, fail over, or schedule a retry.
+    void settle(Transfer* transfer, int curl_result);
+
+    /// Called when `job` has no transfer left running: deliver a held
+    /// answer, or retry, or give up.
+    void end_attempt(Job* job);
+
+    /// Cancel `job`'s running transfers and complete it.
+    void finish(Job* job, std::vector<BroadcastResult> results);
+
+    /// Remove `job` from active_.
+    std::unique_ptr<Job> take(Job* job);
+
+    enum class Outcome { Answered, Error, Cancelled };
+
+    /// Update an endpoint's health and counters after a transfer.
+    void record(std::size_t endpoint, Outcome outcome, double elapsed_s);
+
+    /// Copy the worker's queue sizes into the shared counters.
+    void publish();
+
+    /// Deliver the outcomes and update counters.
+    void complete(std::unique_ptr<Job> job, std::vector<BroadcastResult> results);
+
+    /// Complete every transaction of `job` with `error`.
+    void fail(std::unique_ptr<Job> job, const std::string& error);
+
+    /// Fill the outcomes from the response to a transfer. Returns true
+    /// when the request is worth repeating.
+    bool parse_mempool(const Transfer& transfer, BroadcastResult& result) const;
+    bool parse_rpc(const Transfer& transfer, std::vector<BroadcastResult>& results) const;
+
+    /// sendrawtransaction request body: one call, or a batch array.
+    static std::string rpc_request(const std::vector<std::string>& txs);
 
-    std::string broadcast_mempool(std::string_view raw_tx_hex);
-    std::string broadcast_rpc(std::string_view raw_tx_hex);
+    /// Backoff after `attempt` attempts, from a uniform random draw.
+    Clock::duration backoff(int attempt, uint32_t random) const;
 };
 
 } // namespace btccw::node
@@ -1,39 +1,142 @@
 #ifndef BTCCW_NODE_GOERTZEL_HPP
 #define BTCCW_NODE_GOERTZEL_HPP
 
+#include <complex>
 #include <cstddef>
 #include <vector>
 
+#include "noise_tracker.hpp"
+#include "threshold_estimator.hpp"
+#include "tone_bits.hpp"
+
 namespace btccw::node {
 
 /// Single-frequency tone detector using the Goertzel algorithm.
 ///
 /// Processes mono PCM in fixed-size blocks and outputs a boolean stream
-/// indicating tone present/absent per block.
+/// indicating tone present/absent per block (packed, see ToneBits).
+///
+/// With a hop smaller than the block the analysis window slides: one
+/// decision is made every `hop_size` samples over the last `block_size`
+/// samples, keeping the frequency selectivity of the full block while
+/// refining timing to the hop. The sliding bin is updated per sample
+/// (sliding DFT, exact for the integer bin k) and re-derived from the
+/// window every kResyncWindows windows to stop rounding drift.
 class GoertzelDetector {
 public:
+    /// Incremental detector state, carried across push() calls.
+    struct StreamState {
+        double      s1     = 0.0;
+        double      s2     = 0.0;
+        std::size_t filled = 0;      // samples accumulated in the current block
+        bool        tone   = false;  // hysteresis state
+
+        // Sliding mode: the last block_size samples and their DFT bin.
+        std::vector<float>   window;
+        std::size_t          window_pos   = 0;   // oldest sample
+        std::complex<double> bin;
+        std::size_t          since_hop    = 0;
+        std::size_t          since_resync = 0;
+
+        std::vector<double> mags;        // scratch: magnitudes from one push
+
+        ThresholdEstimator  estimator;   // auto-threshold median
+        NoiseTracker        tracker;     // ThresholdMode::Adaptive
+    };
+
     /// Construct a detector for the given frequency.
     /// @param sample_rate  Audio sample rate (e.g. 44100)
     /// @param tone_freq    Target frequency in Hz (e.g. 750)
     /// @param block_size   Samples per analysis block (e.g. 882 for ~20ms at 44100 Hz)
     /// @param threshold    Detection threshold; 0 = auto (median * 3.0)
+    /// @param hop_size     Samples between decisions; 0 or >= block_size =
+    ///                     non-overlapping blocks (e.g. 220 for ~5 ms steps)
+    /// @param mode         Median estimator for the auto-threshold
+    /// @param noise_window Decisions spanned by the Adaptive noise tracker
     GoertzelDetector(double sample_rate, double tone_freq,
-                     std::size_t block_size = 882, double threshold = 0.0);
+                     std::size_t block_size = 882, double threshold = 0.0,
+                     std::size_t hop_size = 0,
+                     ThresholdMode mode = ThresholdMode::Histogram,
+                     std::size_t noise_window = kNoiseWindow);
+
+    /// Process a PCM buffer and return tone present/absent per hop.
+    ToneBits detect(const std::vector<float>& pcm) const;
+
+    /// Per-hop magnitudes (Goertzel power) for a PCM buffer.
+    std::vector<double> magnitudes(const std::vector<float>& pcm) const;
+
+    /// Tone decisions for magnitudes() output, with this detector's
+    /// threshold settings. detect() is magnitudes() followed by decide().
+    ToneBits decide(const std::vector<double>& mags) const;
 
-    /// Process a PCM buffer and return tone present/absent per block.
-    std::vector<bool> detect(const std::vector<float>& pcm) const;
+    /// Streaming variant of detect(): consume `count` samples, carrying the
+    /// partial block and hysteresis state in `st`. Appends one tone decision
+    /// to `out` for every hop completed by this call.
+    ///
+    /// In auto-threshold mode the median is a running estimate over the
+    /// last ~kSortWindow blocks (Histogram: halved every kHistHalfLife;
+    /// Sort: a window of exactly kSortWindow; Adaptive: the tracker over
+    /// the last noise_window decisions).
+    void push(StreamState& st, const float* samples, std::size_t count,
+              ToneBits& out) const;
 
     std::size_t block_size() const noexcept { return block_size_; }
+    std::size_t hop_size() const noexcept { return hop_size_; }
+    ThresholdMode threshold_mode() const noexcept { return mode_; }
+    std::size_t noise_window() const noexcept { return noise_window_; }
+
+    /// Default Adaptive window: 250 blocks (~5 s at 20 ms).
+    static constexpr std::size_t kNoiseWindow = 250;
+
+    /// Sliding windows between exact recomputations of the running bin.
+    static constexpr std::size_t kResyncWindows = 64;
+
+    /// Hysteresis thresholding shared by detect() and GoertzelBank.
+    /// @param mags       Per-block magnitudes
+    /// @param threshold  ON threshold; 0 = auto (median * 3.0)
+    /// @param mode       Median estimator used when threshold is 0
+    /// @param noise_window  Adaptive mode: decisions per tracker window
+    static ToneBits apply_threshold(const std::vector<double>& mags,
+                                    double threshold,
+                                    ThresholdMode mode = ThresholdMode::Histogram,
+                                    std::size_t noise_window = kNoiseWindow);
 
 private:
     double      sample_rate_;
     double      tone_freq_;
     std::size_t block_size_;
     double      threshold_;
+    std::size_t hop_size_;
+    ThresholdMode mode_;
+    std::size_t noise_window_;
     double      coeff_;       // 2 * cos(2π * k / N)
 
-    /// Compute the Goertzel magnitude for a single block.
-    double magnitude(const float* samples, std::size_t count) const;
+    // Sliding mode.
+    std::complex<double>              rotate_;    // e^{+j2πk/N}
+    std::vector<std::complex<double>> twiddle_;   // e^{-j2πkm/N}, m = 0..N-1
+    std::size_t                       resync_hops_ = 0;
+
+    bool sliding() const noexcept { return hop_size_ < block_size_; }
+
+    /// Append the magnitude of every block/hop completed by `samples`.
+    void feed(StreamState& st, const float* samples, std::size_t count,
+              std::vector<double>& mags) const;
+
+    /// DFT bin of the sliding window, computed directly.
+    std::complex<double> window_bin(const StreamState& st) const;
+
+    /// Power from the final two recurrence values of a block.
+    double power(double s1, double s2) const noexcept {
+        return s1 * s1 + s2 * s2 - coeff_ * s1 * s2;
+    }
+
+    /// Record `mag` in the running estimate and return its thresholds.
+    Thresholds stream_thresholds(StreamState& st, double mag) const;
+
+    /// One hysteresis step: ON at t.on, OFF below t.off.
+    static bool hysteresis(bool state, double mag, const Thresholds& t) noexcept {
+        return state ? !(mag < t.off) : (mag >= t.on);
+    }
 };
 
 } // namespace btccw::node
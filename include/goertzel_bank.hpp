@@ -0,0 +1,78 @@
+#ifndef BTCCW_NODE_GOERTZEL_BANK_HPP
+#define BTCCW_NODE_GOERTZEL_BANK_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "goertzel.hpp"
+#include "threshold_estimator.hpp"
+
+namespace btccw::node {
+
+/// Multi-frequency Goertzel filter bank.
+///
+/// Evaluates N frequencies in a single pass over each PCM block: every
+/// sample is loaded and widened once, and the per-bin recurrences are laid
+/// out as contiguous arrays so GoertzelKernel runs several bins per SIMD
+/// lane. Unlike
+/// GoertzelDetector the bins are not rounded to integer k, so stations a
+/// few Hz apart get their own bin.
+///
+/// With a hop of at most half the block every bin slides like
+/// GoertzelDetector's: its complex value is moved one sample at a time
+/// (exact for any frequency, with one extra multiply for the sample that
+/// leaves the window), so a hop costs O(hop) per bin instead of O(block).
+/// Every kResyncWindows windows the bins are re-derived from a full block.
+class GoertzelBank {
+public:
+    /// @param sample_rate  Audio sample rate (e.g. 44100)
+    /// @param freqs        Bin centre frequencies in Hz
+    /// @param block_size   Samples per analysis block (e.g. 882)
+    /// @param threshold    Detection threshold per bin; 0 = auto (median * 3.0)
+    /// @param hop_size     Samples between block starts; 0 = block_size.
+    /// @param mode         Median estimator for the auto-threshold
+    /// @param noise_window Decisions spanned by the Adaptive noise tracker
+    GoertzelBank(double sample_rate, std::vector<double> freqs,
+                 std::size_t block_size = 882, double threshold = 0.0,
+                 std::size_t hop_size = 0,
+                 ThresholdMode mode = ThresholdMode::Histogram,
+                 std::size_t noise_window = GoertzelDetector::kNoiseWindow);
+
+    /// Per-hop magnitudes, hop-major: result[hop * bins() + bin].
+    std::vector<double> magnitudes(const std::vector<float>& pcm) const;
+
+    /// Tone present/absent per hop, one stream per bin.
+    std::vector<ToneBits> detect(const std::vector<float>& pcm) const;
+
+    std::size_t bins() const noexcept { return freqs_.size(); }
+    const std::vector<double>& freqs() const noexcept { return freqs_; }
+    std::size_t block_size() const noexcept { return block_size_; }
+    std::size_t hop_size() const noexcept { return hop_size_; }
+
+    /// `count` frequencies evenly spaced over [lo_hz, hi_hz].
+    static std::vector<double> spread(double lo_hz, double hi_hz, std::size_t count);
+
+private:
+    double              sample_rate_;
+    std::vector<double> freqs_;
+    std::size_t         block_size_;
+    double              threshold_;
+    std::size_t         hop_size_;
+    ThresholdMode       mode_;
+    std::size_t         noise_window_;
+    std::vector<double> coeffs_;   // 2 * cos(2π * f / fs) per bin
+
+    // Sliding mode, real parts then imaginary parts: e^{jw} advances a bin
+    // by one sample, e^{jwN} weighs the sample leaving the window.
+    std::vector<double> rotate_;
+    std::vector<double> leave_;
+    std::size_t         resync_hops_ = 0;
+
+    /// Sliding pays once blocks overlap by half; above that, direct
+    /// blocks through the kernel are cheaper.
+    bool sliding() const noexcept { return 2 * hop_size_ <= block_size_; }
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_GOERTZEL_BANK_HPP
@@ -0,0 +1,59 @@
+#ifndef BTCCW_NODE_GOERTZEL_KERNEL_HPP
+#define BTCCW_NODE_GOERTZEL_KERNEL_HPP
+
+#include <cstddef>
+
+namespace btccw::node {
+
+/// Goertzel inner loops with runtime CPU dispatch.
+///
+/// The vector paths run one independent block (or bin) per SIMD lane —
+/// AVX-512 (8 doubles), AVX2 (4) or SSE2 (2) — with two lane groups in
+/// flight to hide the recurrence latency. The implementation is chosen
+/// once, from the CPU the process runs on.
+///
+/// Tolerance: every lane performs exactly the scalar reference's double
+/// operations in the same order and without FMA contraction, so results
+/// are bit-identical to the *_scalar() references.
+class GoertzelKernel {
+public:
+    /// Power of `count` blocks of `block_size` samples, block b starting at
+    /// pcm + b * stride, at the frequency whose coefficient is `coeff`
+    /// (2 * cos(2π * k / N)). Writes out[0..count).
+    static void block_powers(const float* pcm, std::size_t count,
+                             std::size_t block_size, std::size_t stride,
+                             double coeff, double* out);
+
+    /// Power of one block at `bins` frequencies. `state` is 2 * bins
+    /// doubles; on return it holds each bin's last two recurrence values
+    /// (s[N-1] in [0, bins), s[N-2] in [bins, 2 * bins)). Writes out[0..bins).
+    static void bin_powers(const float* samples, std::size_t block_size,
+                           const double* coeffs, std::size_t bins,
+                           double* state, double* out);
+
+    /// Slide `bins` complex bins by `count` samples, one sample at a time:
+    /// Y <- e^{jw} Y + newest[t] - e^{jwN} oldest[t]. `rotate` holds e^{jw}
+    /// and `leave` e^{jwN}, and `bin` the running values, each as `bins`
+    /// real parts followed by `bins` imaginary parts.
+    static void slide_bins(const float* oldest, const float* newest, std::size_t count,
+                           const double* rotate, const double* leave, std::size_t bins,
+                           double* bin);
+
+    /// Scalar references, always available.
+    static void block_powers_scalar(const float* pcm, std::size_t count,
+                                    std::size_t block_size, std::size_t stride,
+                                    double coeff, double* out);
+    static void bin_powers_scalar(const float* samples, std::size_t block_size,
+                                  const double* coeffs, std::size_t bins,
+                                  double* state, double* out);
+    static void slide_bins_scalar(const float* oldest, const float* newest,
+                                  std::size_t count, const double* rotate,
+                                  const double* leave, std::size_t bins, double* bin);
+
+    /// Name of the selected implementation: "avx512", "avx2", "sse2" or "scalar".
+    static const char* name();
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_GOERTZEL_KERNEL_HPP
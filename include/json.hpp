@@ -0,0 +1,93 @@
+#ifndef BTCCW_NODE_JSON_HPP
+#define BTCCW_NODE_JSON_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace btccw::node {
+
+/// Streaming JSON text builder.
+///
+/// Appends to one string as it goes (reserve() it up front for a known
+/// size), so building a request is linear in its length. Commas are placed
+/// automatically; the caller only has to balance begin/end.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::size_t reserve_bytes = 0) { out_.reserve(reserve_bytes); }
+
+    JsonWriter& begin_object() { return open('{'); }
+    JsonWriter& end_object()   { return close('}'); }
+    JsonWriter& begin_array()  { return open('['); }
+    JsonWriter& end_array()    { return close(']'); }
+
+    /// Object member name; the value call follows.
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);   // escaped string
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(long long number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+    const std::string& str() const noexcept { return out_; }
+    std::string take() { return std::move(out_); }
+
+private:
+    std::string       out_;
+    std::vector<bool> first_;          // per open container: nothing written yet
+    bool              after_key_ = false;
+
+    JsonWriter& open(char bracket);
+    JsonWriter& close(char bracket);
+    void        separate();
+};
+
+/// Parsed JSON document node.
+///
+/// Just enough for RPC responses: numbers are kept as doubles, object
+/// members in document order. Nesting is limited to kMaxDepth so a hostile
+/// response cannot exhaust the stack.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    static constexpr int kMaxDepth = 64;
+
+    /// Parse a whole document (surrounding whitespace allowed).
+    /// Returns false on malformed input.
+    static bool parse(std::string_view text, JsonValue& out);
+
+    Type type() const noexcept { return type_; }
+    bool is_null() const noexcept   { return type_ == Type::Null; }
+    bool is_string() const noexcept { return type_ == Type::String; }
+    bool is_number() const noexcept { return type_ == Type::Number; }
+    bool is_array() const noexcept  { return type_ == Type::Array; }
+    bool is_object() const noexcept { return type_ == Type::Object; }
+
+    bool               as_bool() const noexcept   { return flag_; }
+    double             as_number() const noexcept { return number_; }
+    const std::string& as_string() const noexcept { return text_; }
+
+    /// Array elements (empty for other types).
+    const std::vector<JsonValue>& items() const noexcept { return items_; }
+
+    /// Object member by name, or nullptr.
+    const JsonValue* find(std::string_view name) const noexcept;
+
+private:
+    Type                   type_   = Type::Null;
+    bool                   flag_   = false;
+    double                 number_ = 0.0;
+    std::string            text_;
+    std::vector<JsonValue> items_;   // array elements, or object values
+    std::vector<std::string> keys_;  // object member names, parallel to items_
+
+    friend class JsonParser;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_JSON_HPP
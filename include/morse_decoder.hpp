@@ -1,33 +1,207 @@
 #ifndef BTCCW_NODE_MORSE_DECODER_HPP
 #define BTCCW_NODE_MORSE_DECODER_HPP
 
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "tone_bits.hpp"
+
 namespace btccw::node {
 
+/// A character whose pattern matched nothing. The text carries a '?'
+/// placeholder at `pos`; since '?' is also a Base43 character, erasures are
+/// reported out of band so the deframer can tell them from real data.
+struct Erasure {
+    std::size_t              pos = 0;
+    std::vector<std::string> candidates;   // replacements, most likely first
+};
+
 /// Decodes a boolean tone stream (from GoertzelDetector) back to text.
 ///
 /// Uses MorseEncoder::lookup() to build a reverse table at init — no
-/// duplicated Morse tables.
+/// duplicated Morse tables. A pending character is kept as a packed key
+/// (see pattern_key()) and resolved with one index into a flat 256-entry
+/// table, so decoding allocates nothing beyond the output string.
+///
+/// With auto_speed the dot length is estimated from the signal instead of
+/// being fixed by the configured WPM: the last kRunHistory key-down runs are
+/// split into a dot and a dash cluster (largest between-class variance),
+/// and when the dash/dot ratio is plausible the unit becomes the pooled
+/// estimate of both. The estimate follows speed drift as runs roll through
+/// the history. Until it first locks, runs are held back and replayed, so
+/// the opening characters are read at the sender's speed rather than the
+/// configured one; an idle gap of kIdleUnits restarts the estimate for the
+/// next transmission.
 class MorseDecoder {
 public:
+    /// Longest pattern a key can hold; longer ones decode as '?'.
+    static constexpr std::size_t kMaxElements = 7;
+
+    /// Key-down runs kept for the speed estimate, and the fewest it uses.
+    static constexpr std::size_t kRunHistory = 32;
+    static constexpr std::size_t kMinRuns    = 8;
+
+    /// Accepted dash/dot length ratios (nominally 3).
+    static constexpr double kMinDashRatio = 1.8;
+    static constexpr double kMaxDashRatio = 5.0;
+
+    /// Estimated speed stays within this factor of the configured speed.
+    static constexpr double kMaxSpeedRatio = 4.0;
+
+    /// Key-up units after which the next run starts a new transmission.
+    static constexpr int kIdleUnits = 20;
+
+    /// Longest key-down run the speed estimate bins, in units of the
+    /// slowest speed followed: a word gap's worth, past any stretched dash.
+    static constexpr double kMaxRunUnits = 7.0;
+
+    /// Runs held back at most before falling back to the configured speed.
+    static constexpr std::size_t kMaxPendingRuns = 4 * kRunHistory;
+
+    /// Incremental decoder state, carried across push() calls.
+    struct StreamState {
+        bool        on    = false;
+        int         count = 0;      // length of the current run in blocks
+
+        // Pending character: element i in bit i (1 = dash), `len` elements.
+        uint8_t     bits = 0;
+        uint8_t     len  = 0;
+
+        // auto_speed: current unit in blocks (0 = configured) and recent
+        // key-down run lengths (ring buffer).
+        double                          unit = 0.0;
+        std::array<int, kRunHistory>    runs{};
+        std::size_t                     runs_len = 0;
+        std::size_t                     runs_pos = 0;
+        std::vector<uint32_t>           hist;   // scratch: histogram of `runs`
+
+        // Until the estimate locks: finished runs, +length ON / -length OFF.
+        bool                                locked = false;
+        std::array<int, kMaxPendingRuns>    pending{};
+        std::size_t                         pending_len = 0;
+
+        // One entry per '?' placeholder written to `out`, indexed into it.
+        // Kept across flush(); the caller consumes and clears them.
+        std::vector<Erasure>                erasures;
+    };
+
     /// @param blocks_per_unit  Number of Goertzel blocks per Morse timing unit.
     ///                         Typically ~3 (unit_duration / block_duration).
-    explicit MorseDecoder(int blocks_per_unit = 3);
+    /// @param auto_speed       Track the sender's speed; blocks_per_unit is
+    ///                         then only the initial guess.
+    explicit MorseDecoder(int blocks_per_unit = 3, bool auto_speed = false);
+
+    /// Decode a packed tone stream to text, a whole run at a time. With
+    /// auto_speed the whole stream is clustered first, so decoding starts
+    /// at the right speed.
+    /// @param unit      If non-null, receives the final unit in blocks.
+    /// @param erasures  If non-null, receives the unknown patterns.
+    std::string decode(const ToneBits& tones, double* unit = nullptr,
+                       std::vector<Erasure>* erasures = nullptr) const;
+
+    /// Consume one tone block. Characters are appended to `out` as soon as
+    /// the following gap is long enough to end them, and a space as soon as
+    /// the gap reaches word length, so output lags the audio by one gap.
+    void push(StreamState& st, bool tone, std::string& out) const {
+        push_run(st, tone, 1, out);
+    }
+
+    /// Consume `length` consecutive blocks of the same value; identical to
+    /// that many push() calls.
+    void push_run(StreamState& st, bool tone, int length, std::string& out) const;
 
-    /// Decode a boolean tone stream to text.
-    std::string decode(const std::vector<bool>& tones) const;
+    /// End of stream: classify the open run and emit any pending character.
+    void flush(StreamState& st, std::string& out) const;
+
+    /// Unit in blocks that `st` is decoding with.
+    double unit(const StreamState& st) const noexcept {
+        return st.unit > 0.0 ? st.unit : static_cast<double>(blocks_per_unit_);
+    }
+
+    /// Key up for kIdleUnits or more: the transmission has ended.
+    bool idle(const StreamState& st) const noexcept {
+        return !st.on && st.count >= idle_threshold(st);
+    }
+
+    /// Character for a packed key, or 0 if no character has that pattern.
+    char symbol(unsigned key) const noexcept { return key < table_.size() ? table_[key] : 0; }
+
+    /// Packed key of a ".-" pattern: a 1 bit above `len` elements, element i
+    /// in bit i (1 = dash). 0 if the pattern is empty or too long.
+    static unsigned pattern_key(const char* pattern) noexcept;
+
+    /// Packed key of a pending character (0 if it overflowed).
+    static unsigned pattern_key(uint8_t bits, uint8_t len) noexcept {
+        return len <= kMaxElements ? ((1u << len) | bits) : 0u;
+    }
+
+    /// Characters a pattern that matched nothing may have been meant as:
+    /// one element flipped, split into two characters at a missed gap,
+    /// one element dropped, one element added. At most kMaxRepairCandidates.
+    std::vector<std::string> repair_candidates(unsigned key) const;
+
+    /// Replacements kept per erasure.
+    static constexpr std::size_t kMaxRepairCandidates = 12;
+
+    /// Dot length from a histogram of key-down run lengths (hist[i] runs of
+    /// length i), or 0 if they do not split into a plausible dot/dash pair.
+    static double cluster_unit(const uint32_t* hist, std::size_t bins);
+
+    int  blocks_per_unit() const noexcept { return blocks_per_unit_; }
+    bool auto_speed() const noexcept { return auto_speed_; }
+
+    /// Run-length histogram size for the speed estimate: runs up to
+    /// kMaxRunUnits at kMaxSpeedRatio below the configured speed get their
+    /// own bin, longer ones (a held key) share the last.
+    std::size_t run_bins() const noexcept { return run_bins_; }
 
 private:
-    int blocks_per_unit_;
+    int         blocks_per_unit_;
+    bool        auto_speed_;
+    std::size_t run_bins_;
 
-    /// Reverse lookup: Morse pattern (e.g. ".-") -> character.
-    std::unordered_map<std::string, char> reverse_table_;
+    /// Reverse lookup: packed pattern key -> character (0 = none).
+    std::array<char, 256> table_{};
 
-    /// Build reverse_table_ from MorseEncoder::lookup().
+    /// Build table_ from MorseEncoder::lookup().
     void build_reverse_table();
+
+    /// Append one element to the pending character.
+    static void add_element(StreamState& st, bool dash) noexcept;
+
+    /// Look up the pending pattern, append the character, clear the pattern.
+    void emit_pattern(StreamState& st, std::string& out) const;
+
+    /// Classify the ON run that just ended.
+    void end_on_run(StreamState& st, int length) const;
+
+    /// Record a finished key-down run and refresh the unit estimate.
+    void track_run(StreamState& st, int length) const;
+
+    /// Hold back a finished run during warm-up; replay once locked.
+    void warmup_run(StreamState& st, std::string& out) const;
+
+    /// Decode the held-back runs at the current unit and lock.
+    void replay(StreamState& st, std::string& out) const;
+
+    /// Limit an estimate to kMaxSpeedRatio of blocks_per_unit (0 stays 0).
+    double clamp_unit(double unit) const noexcept;
+
+    /// Run-length boundaries for the current unit, in whole blocks. With a
+    /// fixed unit these are exactly 2 and 5 * blocks_per_unit.
+    int dot_dash_threshold(const StreamState& st) const noexcept {
+        return static_cast<int>(std::ceil(2.0 * unit(st)));
+    }
+    int word_gap_threshold(const StreamState& st) const noexcept {
+        return static_cast<int>(std::ceil(5.0 * unit(st)));
+    }
+    int idle_threshold(const StreamState& st) const noexcept {
+        return static_cast<int>(std::ceil(kIdleUnits * unit(st)));
+    }
 };
 
 } // namespace btccw::node
@@ -8,14 +8,18 @@
 
 #include "audio_io.hpp"
 #include "decode_pipeline.hpp"
+#include "fec_framer.hpp"
 #include "gateway.hpp"
+#include "streaming_decoder.hpp"
+#include "txid_cache.hpp"
 
 namespace btccw::node {
 
 /// Top-level orchestrator that wires Core, Audio, and Network together.
 ///
 /// Transmit path:
-///   raw_tx_hex -> validate -> base43 encode -> frame (CRC) -> morse timing
+///   raw_tx_hex -> validate -> base43 encode -> frame (CRC, optional FEC)
+///              -> morse timing
 ///              -> audio out (PortAudio)
 ///
 /// Receive path:
@@ -26,8 +30,13 @@ public:
     NodeEngine() = default;
 
     /// Initialise all subsystems.
+    /// The sample rate, tone and WPM of `decode_cfg` are taken from
+    /// `audio_cfg`; the remaining fields tune the receive pipeline.
+    /// `frame_cfg` selects the transmit frame format.
     bool init(const AudioConfig& audio_cfg,
-              const GatewayConfig& gw_cfg);
+              const GatewayConfig& gw_cfg,
+              const DecodeConfig& decode_cfg = {},
+              const FrameConfig& frame_cfg = {});
 
     /// Shut down all subsystems.
     void shutdown();
@@ -35,11 +44,20 @@ public:
     // ----- Transmit path -----
 
     /// Encode a raw transaction hex into a framed Morse timing array.
+    /// With FrameConfig::fragment_chars set, a long payload becomes several
+    /// frames back to back; `fragments` then picks which ones to send (a
+    /// resend of what a receiver is missing), empty = all.
     /// Returns the timing array, or empty on validation failure.
-    std::vector<int8_t> encode_tx(std::string_view raw_tx_hex);
+    std::vector<int8_t> encode_tx(std::string_view raw_tx_hex,
+                                  const std::vector<std::size_t>& fragments = {});
 
-    /// Play the encoded timing array as audio.
-    bool play(const std::vector<int8_t>& timing);
+    /// Play the encoded timing array as audio, reporting progress to
+    /// `on_progress` (if set) while it plays.
+    bool play(const std::vector<int8_t>& timing,
+              const AudioIO::ProgressCallback& on_progress = {});
+
+    /// Progress of the transmission playing (or last played).
+    TransmitProgress transmit_progress() const { return audio_.transmit_progress(); }
 
     /// One-shot: validate, encode, frame, and play a raw transaction.
     bool transmit(std::string_view raw_tx_hex);
@@ -52,18 +70,74 @@ public:
     /// Decode a PCM buffer through the full receive pipeline.
     DecodeResult decode_audio(const std::vector<float>& pcm);
 
+    /// Decode a PCM buffer on every configured filter-bank channel.
+    std::vector<DecodeResult> decode_audio_multi(const std::vector<float>& pcm);
+
     /// Capture audio and decode in one step.
     DecodeResult listen_and_decode(double duration_sec);
 
+    /// Capture audio for `duration_sec`, decoding while it arrives.
+    /// `on_frame` fires for each CRC-valid frame as soon as its " AR" is
+    /// heard; a fragment that completes its transaction arrives as the
+    /// whole transaction. Returns the number of frames recovered.
+    std::size_t listen_stream(double duration_sec,
+                              const StreamingDecoder::FrameCallback& on_frame);
+
+    /// Capture and decode continuously until stop_listening(): the capture
+    /// consumer thread feeds a StreamingDecoder, and `on_frame` fires on
+    /// that thread as listen_stream()'s does. Needs CaptureMode::Callback.
+    bool start_listening(StreamingDecoder::FrameCallback on_frame);
+
+    /// Stop continuous capture, join its thread and flush the decoder.
+    void stop_listening();
+
+    /// Fragmented transactions collected so far, across captures.
+    const Reassembler& reassembler() const noexcept { return reassembler_; }
+
+    /// Capture ring counters (callback capture mode).
+    CaptureStats capture_stats() const { return audio_.capture_stats(); }
+
     // ----- Network -----
 
     /// Broadcast a validated raw transaction to the Bitcoin network.
+    /// A transaction broadcast recently (GatewayConfig::dedupe) is not
+    /// sent again; its locally computed txid is returned.
     std::string broadcast(std::string_view raw_tx_hex);
 
+    /// Broadcast several transactions at once (one JSON-RPC batch against
+    /// Bitcoin Core). Invalid ones are refused without being sent.
+    std::vector<BroadcastResult> broadcast_batch(const std::vector<std::string_view>& raw_txs);
+
+    /// Validate and queue a broadcast without waiting; `done` receives the
+    /// outcome on the gateway's thread (see Gateway::broadcast_async()).
+    void broadcast_async(std::string_view raw_tx_hex, Gateway::BroadcastCallback done);
+
+    /// Gateway queue depth, retries and latency.
+    GatewayStats gateway_stats() const { return gateway_.stats(); }
+
+    /// Repeats answered from the recently-broadcast set.
+    TxidCacheStats txid_cache_stats() const { return txid_cache_.stats(); }
+
 private:
     AudioIO audio_;
     Gateway gateway_;
+    FrameConfig frame_cfg_;
+    Reassembler reassembler_;
     std::unique_ptr<DecodePipeline> decode_pipeline_;
+    std::unique_ptr<StreamingDecoder> listener_;   // start_listening() .. stop_listening()
+    TxidCache txid_cache_;
+
+    /// Local txid of a validated transaction (empty if it does not parse),
+    /// and whether it was broadcast recently.
+    bool already_broadcast(std::string_view raw_tx_hex, std::string& txid);
+
+    /// Remember a successful broadcast. Warns if the gateway's txid
+    /// differs from the local one.
+    void remember(const std::string& txid, const std::string& reported);
+
+    /// Feed a fragment result to the reassembler. When it completes its
+    /// transaction, `result` becomes the decode of the whole payload.
+    void collect(DecodeResult& result);
 };
 
 } // namespace btccw::node
@@ -0,0 +1,87 @@
+#ifndef BTCCW_NODE_NOISE_TRACKER_HPP
+#define BTCCW_NODE_NOISE_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "threshold_estimator.hpp"
+
+namespace btccw::node {
+
+/// Adaptive tone decision from the local noise floor and signal level.
+///
+/// Keeps the last `window` magnitudes in a log-magnitude histogram (the
+/// ThresholdEstimator bin layout), together with the tone decision made
+/// for each. The key-down fraction f of the window tells which part of the
+/// histogram is noise: the noise power is recovered from a low quantile
+/// taken inside the key-up share, and the signal level is the median of
+/// the key-down share. Each block is then judged against its own ON/OFF
+/// pair, placed between the two in the log domain and never closer to the
+/// noise than kOnSnr / kOffSnr.
+///
+/// The level follows QSB fading and slow band-noise changes with a lag of
+/// about half a window. Work per block is constant, and the tracker is
+/// causal, so batch and streaming decisions are identical.
+class NoiseTracker {
+public:
+    NoiseTracker() = default;
+
+    /// @param window  Magnitudes (blocks or hops) the estimates span
+    explicit NoiseTracker(std::size_t window);
+
+    /// Judge one magnitude; returns the thresholds it was judged against.
+    Thresholds update(double mag);
+
+    /// Decision for the last magnitude passed to update().
+    bool tone() const noexcept { return tone_; }
+
+    /// Mean noise power and median key-down power; 0 when not yet known.
+    double noise_floor() const noexcept { return noise_; }
+    double signal() const noexcept { return signal_; }
+
+    std::size_t window() const noexcept { return window_; }
+
+    /// Quantile of the key-up share used to estimate the noise power.
+    static constexpr double kFloorQuantile = 0.25;
+
+    /// ON/OFF never below these multiples of the mean noise power
+    /// (Rayleigh false-alarm rate e^-10 and e^-6 per block).
+    static constexpr double kOnSnr  = 10.0;
+    static constexpr double kOffSnr = 6.0;
+
+    /// ON = noise * (signal / noise)^kOnExponent; OFF likewise.
+    static constexpr double kOnExponent  = 0.50;
+    static constexpr double kOffExponent = 0.35;
+
+private:
+    /// A bin and the number of samples in the bins below it.
+    struct Cursor {
+        std::size_t bin   = 0;
+        std::size_t below = 0;
+    };
+
+    static constexpr uint16_t kToneFlag = 0x8000;   // ring entry: decision bit
+
+    std::size_t           window_ = 0;
+    std::vector<uint16_t> ring_;       // bin | kToneFlag per sample in the window
+    std::size_t           ring_pos_  = 0;
+    std::size_t           count_     = 0;
+    std::size_t           on_count_  = 0;
+    std::vector<uint32_t> hist_;
+    Cursor                floor_;
+    Cursor                signal_cursor_;
+    double                noise_  = 0.0;
+    double                signal_ = 0.0;
+    bool                  tone_   = false;
+
+    void add(std::size_t bin);
+    void remove(std::size_t bin);
+
+    /// Move `c` onto the bin holding sorted index `target`.
+    void settle(Cursor& c, std::size_t target);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_NOISE_TRACKER_HPP
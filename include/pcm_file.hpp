@@ -0,0 +1,79 @@
+#ifndef BTCCW_NODE_PCM_FILE_HPP
+#define BTCCW_NODE_PCM_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace btccw::node {
+
+/// Sample encodings a recording may hold.
+enum class SampleFormat {
+    S16,   // signed 16-bit little-endian
+    F32    // IEEE float32 little-endian
+};
+
+/// Layout of the samples in a PCM file.
+struct PcmFormat {
+    SampleFormat format      = SampleFormat::S16;
+    double       sample_rate = 44100.0;
+    int          channels    = 1;
+};
+
+/// A WAV or headerless PCM recording, memory-mapped read-only.
+///
+/// Nothing is copied on open(): read() converts a range of frames to mono
+/// float straight from the mapping (channels averaged), so a recording of
+/// any length costs one small buffer, and the kernel pages the file in
+/// ahead of a sequential reader.
+class PcmFile {
+public:
+    PcmFile() = default;
+    ~PcmFile();
+
+    PcmFile(const PcmFile&) = delete;
+    PcmFile& operator=(const PcmFile&) = delete;
+
+    /// Map `path`. A RIFF/WAVE file (16-bit PCM or float32, any channel
+    /// count) describes itself; anything else is taken as raw samples in
+    /// `raw` layout, float32 if the name ends in ".f32". On failure,
+    /// error() says why.
+    bool open(const std::string& path, const PcmFormat& raw = {});
+
+    /// Unmap the file.
+    void close();
+
+    bool is_open() const noexcept { return data_ != nullptr; }
+
+    const PcmFormat& format() const noexcept { return format_; }
+
+    /// Frames (one sample per channel) in the file.
+    std::size_t frames() const noexcept { return frames_; }
+
+    double duration_s() const noexcept {
+        return static_cast<double>(frames_) / format_.sample_rate;
+    }
+
+    /// Convert up to `count` frames starting at `first` to mono float in
+    /// `out`. Returns the number converted (fewer at the end of the file).
+    std::size_t read(std::size_t first, std::size_t count, float* out) const;
+
+    const std::string& error() const noexcept { return error_; }
+
+private:
+    void*          map_      = nullptr;
+    std::size_t    map_size_ = 0;
+    const uint8_t* data_     = nullptr;   // first sample
+    std::size_t    frames_   = 0;
+    PcmFormat      format_;
+    std::string    error_;
+
+    /// Find the "fmt " and "data" chunks of a RIFF/WAVE mapping.
+    bool parse_wav(const uint8_t* file, std::size_t size);
+
+    bool fail(std::string why);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_PCM_FILE_HPP
@@ -0,0 +1,94 @@
+#ifndef BTCCW_NODE_RING_BUFFER_HPP
+#define BTCCW_NODE_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace btccw::node {
+
+/// Fixed-capacity lock-free single-producer / single-consumer ring buffer.
+///
+/// Safe for exactly one writer thread and one reader thread (e.g. the
+/// PortAudio callback and a consumer). Neither side allocates, locks or
+/// blocks after construction. Capacity is rounded up to a power of two.
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SpscRingBuffer copies elements with memcpy");
+
+public:
+    explicit SpscRingBuffer(std::size_t min_capacity)
+        : capacity_(round_up_pow2(min_capacity)),
+          mask_(capacity_ - 1),
+          data_(capacity_) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /// Producer: append up to `count` elements. Returns how many fit.
+    std::size_t write(const T* src, std::size_t count) noexcept {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        const std::size_t n    = std::min(count, capacity_ - (head - tail));
+
+        copy_in(head & mask_, src, n);
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Consumer: remove up to `count` elements into `dst`. Returns how many.
+    std::size_t read(T* dst, std::size_t count) noexcept {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t n    = std::min(count, head - tail);
+
+        copy_out(tail & mask_, dst, n);
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Elements currently buffered (approximate when called concurrently).
+    std::size_t size() const noexcept {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    // Keep producer and consumer indices on separate cache lines.
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::size_t    capacity_;
+    std::size_t    mask_;
+    std::vector<T> data_;
+
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};  // written by producer
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};  // written by consumer
+
+    static std::size_t round_up_pow2(std::size_t n) {
+        std::size_t cap = 1;
+        while (cap < n) cap <<= 1;
+        return cap;
+    }
+
+    void copy_in(std::size_t pos, const T* src, std::size_t n) noexcept {
+        const std::size_t first = std::min(n, capacity_ - pos);
+        std::memcpy(data_.data() + pos, src, first * sizeof(T));
+        std::memcpy(data_.data(), src + first, (n - first) * sizeof(T));
+    }
+
+    void copy_out(std::size_t pos, T* dst, std::size_t n) const noexcept {
+        const std::size_t first = std::min(n, capacity_ - pos);
+        std::memcpy(dst, data_.data() + pos, first * sizeof(T));
+        std::memcpy(dst + first, data_.data(), (n - first) * sizeof(T));
+    }
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_RING_BUFFER_HPP
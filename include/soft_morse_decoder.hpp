@@ -0,0 +1,110 @@
+#ifndef BTCCW_NODE_SOFT_MORSE_DECODER_HPP
+#define BTCCW_NODE_SOFT_MORSE_DECODER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "morse_decoder.hpp"
+
+namespace btccw::node {
+
+/// One text hypothesis from SoftMorseDecoder, best first.
+struct SoftCandidate {
+    std::string text;
+    double      score = 0.0;   // log-likelihood ratio against "no tone at all"
+};
+
+/// Soft-decision Morse decoder working on Goertzel magnitudes.
+///
+/// The hard path thresholds every decision before MorseDecoder sees it, so
+/// one noise spike inside a dash splits it into two dots. This decoder keeps
+/// the magnitudes instead: each one becomes a tone/no-tone log-likelihood
+/// ratio (Rician against Rayleigh, levels from a NoiseTracker), and a beam
+/// search lays element and gap segments over the stream. A segment scores
+/// the sum of its ratios plus a log-normal prior on its length around
+/// 1, 3 or 7 units; hypotheses are kept per end position, merged when they
+/// carry the same text and Morse state, and cut to the beam width. Patterns
+/// that no character starts with are never extended.
+///
+/// The result is the best few distinct texts; the caller picks the one the
+/// frame CRC accepts. Work per decision is bounded by the beam width times
+/// the longest segment (about 8 units), independent of the signal.
+class SoftMorseDecoder {
+public:
+    /// Hypotheses kept per end position.
+    static constexpr std::size_t kBeamWidth = 64;
+
+    /// Distinct texts returned.
+    static constexpr std::size_t kCandidates = 8;
+
+    /// Spread of segment lengths around nominal, in natural-log units.
+    static constexpr double kLengthSigma = 0.3;
+
+    /// Segment lengths whose prior falls below this are not tried.
+    static constexpr double kMinLengthPrior = -4.5;
+
+    /// Longest single segment, in units; longer silences chain idle segments.
+    static constexpr double kMaxSegmentUnits = 8.0;
+
+    /// @param symbols     Reverse table to decode with (MorseDecoder::symbol())
+    /// @param beam_width  Hypotheses kept per end position
+    /// @param candidates  Distinct texts returned by decode()
+    explicit SoftMorseDecoder(const MorseDecoder& symbols,
+                              std::size_t beam_width = kBeamWidth,
+                              std::size_t candidates = kCandidates);
+
+    /// Decode a magnitude stream at `unit` decisions per Morse unit.
+    /// @param noise_window  Decisions spanned by the level tracker
+    std::vector<SoftCandidate> decode(const std::vector<double>& mags, double unit,
+                                      std::size_t noise_window) const;
+
+    /// Per-decision log-likelihood ratio of tone against no tone.
+    static std::vector<double> log_likelihoods(const std::vector<double>& mags,
+                                               std::size_t noise_window);
+
+    std::size_t beam_width() const noexcept { return beam_width_; }
+    std::size_t candidates() const noexcept { return candidates_; }
+
+private:
+    /// Segment kinds; the first two are key-down.
+    enum Segment : uint8_t { Dot, Dash, ElementGap, CharGap, WordGap, Idle, kSegments };
+
+    /// What the next segment must be.
+    enum Phase : uint8_t { ExpectGap, ExpectTone, Between };
+
+    /// A partial decode ending at one position.
+    struct Hypothesis {
+        double   score = 0.0;
+        uint64_t hash  = 14695981039346656037ull;   // text so far (FNV-1a)
+        uint32_t node  = 0;       // text so far (arena chain), without `pend`
+        uint8_t  key   = 1;       // pending pattern, MorseDecoder::pattern_key()
+        uint8_t  phase = Between;
+        char     pend[2] = {};    // emitted but not yet in the arena
+        uint8_t  pend_len = 0;
+    };
+
+    /// Text arena: each node is one character after its parent.
+    struct TextNode {
+        uint32_t parent;
+        char     c;
+    };
+
+    std::size_t beam_width_;
+    std::size_t candidates_;
+
+    std::array<char, 256> table_{};    // packed key -> character
+    std::array<bool, 256> prefix_{};   // packed key starts some character
+
+    /// Keep the best hypothesis per text/state, then the best beam_width_.
+    void prune(std::vector<Hypothesis>& bucket) const;
+
+    static void emit(Hypothesis& h, char c) noexcept;
+    static std::string text_of(const std::vector<TextNode>& arena, const Hypothesis& h);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_SOFT_MORSE_DECODER_HPP
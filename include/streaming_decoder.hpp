@@ -0,0 +1,88 @@
+#ifndef BTCCW_NODE_STREAMING_DECODER_HPP
+#define BTCCW_NODE_STREAMING_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "decode_pipeline.hpp"
+
+namespace btccw::node {
+
+/// Push-based receive pipeline.
+///
+/// Accepts PCM in arbitrary chunk sizes and carries the Goertzel partial
+/// block, hysteresis state, partial Morse character and partial frame text
+/// across calls. The frame callback fires as soon as a CRC-valid
+/// "KKK ... AR" has been decoded, so latency is bounded by one Goertzel
+/// block plus one character rather than by the capture length.
+class StreamingDecoder {
+public:
+    /// Called once per CRC-valid frame with the stage 3-5 result.
+    using FrameCallback = std::function<void(const DecodeResult&)>;
+
+    /// @param pipeline  Supplies detector and decoder settings; must outlive
+    ///                  this object.
+    /// @param on_frame  Invoked from push()/flush() on the caller's thread.
+    StreamingDecoder(const DecodePipeline& pipeline, FrameCallback on_frame);
+
+    /// Feed `count` mono samples.
+    void push(const float* samples, std::size_t count);
+
+    /// Feed already-decoded text (e.g. from a batch Morse pass) straight
+    /// to the frame scanner. Erasure positions are indices into `text`.
+    void push_text(const std::string& text,
+                   const std::vector<Erasure>& erasures = {});
+
+    /// End of stream: emit the pending character and check for a final frame.
+    void flush();
+
+    /// Discard all carried state.
+    void reset();
+
+    /// Decoded text not yet consumed by a frame (for diagnostics).
+    const std::string& pending_text() const noexcept { return text_; }
+
+    /// A preamble has been heard that no " AR" has closed yet, and the key
+    /// has not since gone idle (no sender pauses that long inside a frame).
+    bool frame_open() const noexcept;
+
+    /// Morse unit the decoder is following, in Goertzel blocks
+    /// (DecodePipeline::unit_to_wpm() gives the sender's speed).
+    double unit() const noexcept { return pipeline_.morse_decoder().unit(morse_state_); }
+
+    /// Total samples consumed since construction or reset().
+    uint64_t samples_consumed() const noexcept { return samples_; }
+
+    /// Upper bound on buffered text while waiting for " AR".
+    static constexpr std::size_t kMaxPendingChars = 1u << 20;
+
+private:
+    const DecodePipeline&         pipeline_;
+    FrameCallback                 on_frame_;
+
+    GoertzelDetector::StreamState tone_state_;
+    MorseDecoder::StreamState     morse_state_;
+    ToneBits                      blocks_;   // scratch: decisions for one push
+    std::string                   text_;     // decoded text since last frame
+    std::vector<Erasure>          erasures_; // unknown symbols in text_
+    uint64_t                      samples_ = 0;
+
+    /// Consume newly appended text starting at `from`.
+    void scan_text(std::size_t from);
+
+    /// Take the erasures the Morse decoder recorded into text_.
+    void collect_erasures();
+
+    /// Drop the first `count` characters of text_ and their erasures.
+    void consume(std::size_t count);
+
+    /// Try every "KKK " start before a " AR" ending at `end`.
+    bool try_frame(std::size_t end);
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_STREAMING_DECODER_HPP
@@ -0,0 +1,105 @@
+#ifndef BTCCW_NODE_THRESHOLD_ESTIMATOR_HPP
+#define BTCCW_NODE_THRESHOLD_ESTIMATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace btccw::node {
+
+/// How the auto-threshold estimates the median Goertzel magnitude.
+enum class ThresholdMode {
+    Sort,       ///< Exact median; windowed (kSortWindow) when streaming
+    Histogram,  ///< Log-magnitude histogram, 1/8-octave bins, O(1) per update
+    Adaptive,   ///< Per-block thresholds from NoiseTracker (no global median)
+};
+
+/// Hysteresis pair: turn ON at `on`, turn OFF below `off`.
+struct Thresholds {
+    double on  = 0.0;
+    double off = 0.0;
+};
+
+/// Running median of Goertzel magnitudes for the auto-threshold.
+///
+/// Histogram uses fixed memory (4 KiB) and constant work per add(). It
+/// stays within one bin (9%, typically under 3%) of the exact median. A
+/// running estimate forgets: every kHistHalfLife magnitudes all bins are
+/// halved, so like Sort's window it follows the last ~30 s and a threshold
+/// set by band conditions hours ago does not stick. median_of() keeps
+/// every magnitude of the buffer. Sort is the exact reference: it keeps
+/// the last kSortWindow magnitudes and selects from them on each query.
+///
+/// Marker-based estimators such as P² were not used: Goertzel magnitudes
+/// are strongly bimodal (noise vs. tone) and their interpolated median
+/// lands in the gap between the two clusters.
+class ThresholdEstimator {
+public:
+    ThresholdEstimator() = default;
+    explicit ThresholdEstimator(ThresholdMode mode);
+
+    /// Record one magnitude.
+    void add(double mag);
+
+    /// Current median estimate; 0 before the first add().
+    double median() const;
+
+    /// Magnitudes the estimate is taken over (Histogram: after halving).
+    std::size_t count() const noexcept { return count_; }
+
+    ThresholdMode mode() const noexcept { return mode_; }
+
+    void reset();
+
+    /// Median of a whole buffer using `mode` (Sort: exact selection).
+    static double median_of(const std::vector<double>& mags, ThresholdMode mode);
+
+    /// Magnitudes kept by Sort mode when streaming (~30 s of 20 ms blocks).
+    static constexpr std::size_t kSortWindow = 1500;
+
+    /// Running Histogram: magnitudes between halvings. The weight then
+    /// stays below kSortWindow.
+    static constexpr std::size_t kHistHalfLife = kSortWindow / 2;
+
+    /// Histogram layout: bins cover 2^kHistMinLog2 .. 2^(kHistMinLog2 + kHistBins / kHistBinsPerOctave).
+    static constexpr int         kHistBinsPerOctave = 8;
+    static constexpr int         kHistMinLog2       = -64;
+    static constexpr std::size_t kHistBins          = 128 * kHistBinsPerOctave;
+
+    /// Histogram bin holding `mag` (0 for mag <= 0).
+    static std::size_t hist_bin(double mag) noexcept;
+
+    /// Magnitude at fractional bin position `pos`.
+    static double hist_value(double pos) noexcept;
+
+private:
+    ThresholdMode mode_  = ThresholdMode::Histogram;
+    std::size_t   count_ = 0;
+
+    // Sort: recent magnitudes (ring buffer) and selection scratch.
+    std::vector<double>         history_;
+    std::size_t                 history_pos_ = 0;
+    mutable std::vector<double> scratch_;
+
+    // Histogram: counts per bin, plus the bin holding the median and the
+    // number of samples below it (moved by at most a few bins per add).
+    std::array<uint32_t, kHistBins> hist_{};
+    std::size_t                     cursor_ = 0;
+    std::size_t                     below_  = 0;
+    bool                            forget_ = true;   // false for median_of()
+    std::size_t                     since_halving_ = 0;
+
+    void add_sort(double mag);
+    void add_histogram(double mag);
+
+    /// Halve every bin and put the cursor back on the median.
+    void halve_histogram();
+
+    double median_sort() const;
+    double median_histogram() const;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_THRESHOLD_ESTIMATOR_HPP
@@ -0,0 +1,85 @@
+#ifndef BTCCW_NODE_TONE_BITS_HPP
+#define BTCCW_NODE_TONE_BITS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace btccw::node {
+
+/// Tone present/absent per block, packed 64 decisions per word (bit i of
+/// word i / 64 holds decision i, LSB first).
+///
+/// Consumers walk it run by run: find_next() skips a whole run with one
+/// count-trailing-zeros per word instead of testing every decision.
+class ToneBits {
+public:
+    ToneBits() = default;
+
+    /// `count` decisions, all OFF.
+    explicit ToneBits(std::size_t count)
+        : words_((count + 63) / 64), size_(count) {}
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    bool operator[](std::size_t i) const noexcept {
+        return (words_[i / 64] >> (i % 64)) & 1u;
+    }
+
+    void set(std::size_t i, bool on) noexcept {
+        const uint64_t bit = uint64_t{1} << (i % 64);
+        if (on) {
+            words_[i / 64] |= bit;
+        } else {
+            words_[i / 64] &= ~bit;
+        }
+    }
+
+    void push_back(bool on) {
+        if (size_ % 64 == 0) words_.push_back(0);
+        if (on) words_[size_ / 64] |= uint64_t{1} << (size_ % 64);
+        ++size_;
+    }
+
+    void clear() noexcept {
+        words_.clear();
+        size_ = 0;
+    }
+
+    void reserve(std::size_t count) { words_.reserve((count + 63) / 64); }
+
+    /// Index of the first decision at or after `from` equal to `value`, or
+    /// size() if there is none.
+    std::size_t find_next(std::size_t from, bool value) const noexcept {
+        if (from >= size_) return size_;
+        const uint64_t flip = value ? 0 : ~uint64_t{0};
+
+        std::size_t w    = from / 64;
+        uint64_t    word = (words_[w] ^ flip) & (~uint64_t{0} << (from % 64));
+        while (word == 0) {
+            if (++w == words_.size()) return size_;
+            word = words_[w] ^ flip;
+        }
+        // Padding bits past size() read as OFF; clamp.
+        return std::min(w * 64 + static_cast<std::size_t>(__builtin_ctzll(word)), size_);
+    }
+
+    const std::vector<uint64_t>& words() const noexcept { return words_; }
+
+    /// Unpacked copy, for callers that want per-block access.
+    std::vector<bool> to_vector() const {
+        std::vector<bool> out(size_);
+        for (std::size_t i = 0; i < size_; ++i) out[i] = (*this)[i];
+        return out;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    std::size_t           size_ = 0;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_TONE_BITS_HPP
@@ -0,0 +1,89 @@
+#ifndef BTCCW_NODE_TONE_SYNTH_HPP
+#define BTCCW_NODE_TONE_SYNTH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace btccw::node {
+
+/// Morse keying to PCM from precomputed element templates.
+///
+/// Every key-down run of a given length looks the same: a carrier from a
+/// sine wavetable (32-bit phase accumulator, continuous through the run)
+/// under a raised-cosine envelope. The rise starts at key-down and the
+/// fall at key-up, so the time between the 50% points is exactly the
+/// nominal length and nothing is lost from a dot. Templates for runs of up
+/// to kMaxTemplateUnits units are built once, so rendering is a zero fill
+/// plus one memcpy per element. Longer runs are synthesised directly.
+///
+/// Each run starts its carrier at phase zero. The envelope is zero there,
+/// so the phase at key-down does not show in the spectrum.
+///
+/// render_next() produces the same samples a block at a time from a Cursor,
+/// for output callbacks that cannot hold the whole transmission.
+class ToneSynth {
+public:
+    static constexpr float       kAmplitude        = 0.8f;
+    static constexpr std::size_t kTableBits        = 12;
+    static constexpr std::size_t kTableSize        = std::size_t{1} << kTableBits;
+    static constexpr std::size_t kMaxTemplateUnits = 7;   // a word gap's worth
+
+    /// Position of a block-by-block rendering, carried between calls.
+    struct Cursor {
+        std::size_t unit    = 0;      // first unit of the current run
+        std::size_t run     = 0;      // its length in units; 0 = not measured yet
+        std::size_t offset  = 0;      // samples into the current run
+        std::size_t fall    = 0;      // units of the key-down run whose fall is due
+        bool        on      = false;  // current run is key-down
+        uint64_t    samples = 0;      // samples written so far
+    };
+
+    /// @param rise_time_s  Raised-cosine edge length; 0 = hard keying.
+    ///                     Capped at half a unit so a fall always ends
+    ///                     before the next element starts.
+    ToneSynth(double sample_rate, double tone_freq_hz, int wpm, double rise_time_s);
+
+    /// Samples the rendering of `timing` takes (one extra edge if it ends
+    /// key-down).
+    std::size_t length(const std::vector<int8_t>& timing) const noexcept;
+
+    /// Render a Morse timing array (+1 = tone unit, -1 = silent unit).
+    std::vector<float> render(const std::vector<int8_t>& timing) const;
+
+    /// As render(), into `out`, reusing its capacity.
+    void render(const std::vector<int8_t>& timing, std::vector<float>& out) const;
+
+    /// Render the next `frames` samples of `timing` from `cursor` into `out`
+    /// and advance it. Returns the number written, short only at the end.
+    /// `timing` must not change between calls. Real-time safe: no locks,
+    /// no allocation.
+    std::size_t render_next(const std::vector<int8_t>& timing, Cursor& cursor,
+                            float* out, std::size_t frames) const noexcept;
+
+    std::size_t samples_per_unit() const noexcept { return samples_per_unit_; }
+    std::size_t edge_samples() const noexcept { return edge_; }
+
+private:
+    std::size_t samples_per_unit_;
+    std::size_t edge_;
+    uint32_t    phase_step_;
+
+    std::array<float, kTableSize + 1> table_{};   // one sine period plus wrap
+    std::vector<float> rise_;                      // envelope, 0 -> 1
+    std::vector<std::vector<float>> templates_;    // index = run length in units
+
+    /// Write samples [first, first + count) of a shaped run of `units`
+    /// units (the fall included) to `out`.
+    void synthesize(std::size_t units, std::size_t first, std::size_t count,
+                    float* out) const noexcept;
+
+    /// As synthesize(), from the template when there is one.
+    void run_samples(std::size_t units, std::size_t first, std::size_t count,
+                     float* out) const noexcept;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_TONE_SYNTH_HPP
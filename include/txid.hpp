@@ -0,0 +1,44 @@
+#ifndef BTCCW_NODE_TXID_HPP
+#define BTCCW_NODE_TXID_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace btccw::node {
+
+/// Incremental SHA-256 (FIPS 180-4).
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256() { reset(); }
+
+    void   reset();
+    void   update(const uint8_t* data, std::size_t len);
+    Digest finish();
+
+    /// One-shot hash of a buffer.
+    static Digest hash(const uint8_t* data, std::size_t len);
+
+private:
+    uint32_t state_[8];
+    uint8_t  block_[64];
+    std::size_t used_  = 0;     // bytes in block_
+    uint64_t    total_ = 0;     // bytes hashed so far
+
+    void compress(const uint8_t* block);
+};
+
+/// Compute a transaction's txid locally: double SHA-256 over the legacy
+/// (non-witness) serialization, shown byte-reversed in hex as block
+/// explorers and Bitcoin Core do. A segwit transaction is hashed without
+/// its marker, flag and witnesses, straight from `raw_tx` with no copy.
+/// Returns false if `raw_tx` does not parse as exactly one transaction.
+bool compute_txid(const std::vector<uint8_t>& raw_tx, std::string& txid);
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_TXID_HPP
@@ -0,0 +1,72 @@
+#ifndef BTCCW_NODE_TXID_CACHE_HPP
+#define BTCCW_NODE_TXID_CACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace btccw::node {
+
+/// Limits for the recently-broadcast set.
+struct TxidCacheConfig {
+    std::size_t capacity = 4096;     // txids held; the least recently seen goes first
+    double      window_s = 3600.0;   // forget a txid this long after its broadcast (0 = never)
+};
+
+/// Cache counters.
+struct TxidCacheStats {
+    uint64_t    hits   = 0;          // repeats answered without a request
+    uint64_t    misses = 0;
+    std::size_t size   = 0;
+};
+
+/// Txids broadcast recently, so a repeated transmission of the same
+/// transaction is answered locally instead of costing another round trip.
+///
+/// An LRU list bounded by capacity, with entries also expiring window_s
+/// after they were added (a hit does not extend that, so a transaction
+/// that dropped out of the mempool is eventually sent again). Locked, as
+/// broadcasts complete on the gateway's thread.
+class TxidCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TxidCache(const TxidCacheConfig& cfg = {}) : cfg_(cfg) {}
+
+    TxidCache(const TxidCache&) = delete;
+    TxidCache& operator=(const TxidCache&) = delete;
+
+    /// Forget everything and apply `cfg`.
+    void reset(const TxidCacheConfig& cfg);
+
+    /// True if `txid` was broadcast within the window. Counts a hit or a miss.
+    bool contains(const std::string& txid, Clock::time_point now = Clock::now());
+
+    /// Remember a broadcast.
+    void insert(const std::string& txid, Clock::time_point now = Clock::now());
+
+    TxidCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::string       txid;
+        Clock::time_point added;
+    };
+
+    TxidCacheConfig    cfg_;
+    mutable std::mutex mutex_;
+    std::list<Entry>   order_;    // most recently seen first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    uint64_t           hits_   = 0;
+    uint64_t           misses_ = 0;
+
+    bool expired(const Entry& entry, Clock::time_point now) const;
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_TXID_CACHE_HPP
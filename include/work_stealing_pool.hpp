@@ -0,0 +1,128 @@
+#ifndef BTCCW_NODE_WORK_STEALING_POOL_HPP
+#define BTCCW_NODE_WORK_STEALING_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace btccw::node {
+
+/// Runs a numbered set of independent tasks on a set of threads.
+///
+/// Each worker starts with an even, contiguous share of the task numbers
+/// and works through it from the front, so neighbouring tasks (adjacent
+/// chunks of one recording) stay on one core. A worker whose share runs
+/// out steals half of what remains from the back of the largest other
+/// share. A few slow tasks, e.g. a noisy hour with many repair searches,
+/// then cannot hold up cores that finished early.
+class WorkStealingPool {
+public:
+    /// Called with a task number and the worker (0 .. workers() - 1)
+    /// running it.
+    using Task = std::function<void(std::size_t task, std::size_t worker)>;
+
+    /// @param workers  Threads per run(); 0 = one per core.
+    explicit WorkStealingPool(std::size_t workers = 0)
+        : workers_(workers ? workers : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t workers() const noexcept { return workers_; }
+
+    /// Run tasks 0 .. count - 1 and return once all are done. The calling
+    /// thread works too; no more threads start than there are tasks.
+    void run(std::size_t count, const Task& task) {
+        const std::size_t n = std::min(workers_, count);
+        if (n == 0) return;
+
+        shares_.clear();
+        for (std::size_t w = 0; w < n; ++w) {
+            auto share = std::make_unique<Share>();
+            share->begin = count * w / n;
+            share->end   = count * (w + 1) / n;
+            shares_.push_back(std::move(share));
+        }
+        steals_ = 0;
+
+        std::vector<std::thread> threads;
+        for (std::size_t w = 1; w < n; ++w) threads.emplace_back([this, &task, w] { work(w, task); });
+        work(0, task);
+        for (auto& thread : threads) thread.join();
+    }
+
+    /// Tasks moved between shares during the last run().
+    std::size_t steals() const noexcept { return steals_; }
+
+private:
+    /// Task numbers [begin, end) not yet started.
+    struct Share {
+        std::mutex  mutex;
+        std::size_t begin = 0;
+        std::size_t end   = 0;
+    };
+
+    std::size_t                         workers_;
+    std::vector<std::unique_ptr<Share>> shares_;
+    std::atomic<std::size_t>            steals_{0};
+
+    void work(std::size_t self, const Task& task) {
+        Share& own = *shares_[self];
+        for (;;) {
+            std::size_t next = 0;
+            bool        have = false;
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (own.begin < own.end) {
+                    next = own.begin++;
+                    have = true;
+                }
+            }
+            if (have) {
+                task(next, self);
+            } else if (!steal(self)) {
+                return;
+            }
+        }
+    }
+
+    /// Move the back half of the largest other share into ours. False once
+    /// every share is empty.
+    bool steal(std::size_t self) {
+        for (;;) {
+            std::size_t victim = shares_.size();
+            std::size_t most   = 0;
+            for (std::size_t w = 0; w < shares_.size(); ++w) {
+                if (w == self) continue;
+                std::lock_guard<std::mutex> lock(shares_[w]->mutex);
+                const std::size_t left = shares_[w]->end - shares_[w]->begin;
+                if (left > most) {
+                    most   = left;
+                    victim = w;
+                }
+            }
+            if (victim == shares_.size()) return false;
+
+            Share& from = *shares_[victim];
+            Share& own  = *shares_[self];
+            std::scoped_lock lock(from.mutex, own.mutex);
+            const std::size_t left = from.end - from.begin;
+            if (left == 0) continue;   // emptied meanwhile: look again
+            const std::size_t take = (left + 1) / 2;
+            own.begin = from.end - take;
+            own.end   = from.end;
+            from.end -= take;
+            steals_ += take;
+            return true;
+        }
+    }
+};
+
+} // namespace btccw::node
+
+#endif // BTCCW_NODE_WORK_STEALING_POOL_HPP
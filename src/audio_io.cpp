@@ -1,7 +1,11 @@
 #include "audio_io.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <limits>
 
 namespace btccw::node {
 
@@ -15,6 +19,8 @@ AudioIO::~AudioIO() { close(); }
 
 bool AudioIO::open(const AudioConfig& cfg) {
     cfg_ = cfg;
+    synth_ = std::make_unique<ToneSynth>(cfg_.sample_rate, cfg_.tone_freq_hz, cfg_.wpm,
+                                         cfg_.rise_time_ms / 1000.0);
 
     PaError err = Pa_Initialize();
     if (err != paNoError) {
@@ -34,9 +40,11 @@ bool AudioIO::open(const AudioConfig& cfg) {
     out_params.suggestedLatency =
         Pa_GetDeviceInfo(out_params.device)->defaultLowOutputLatency;
 
+    // Transmit audio is rendered in the callback as the device asks for
+    // it, never held whole.
     err = Pa_OpenStream(&output_stream_, nullptr, &out_params,
                         cfg_.sample_rate, paFramesPerBufferUnspecified,
-                        paClipOff, nullptr, nullptr);
+                        paClipOff, &AudioIO::output_callback, this);
     if (err != paNoError) {
         std::fprintf(stderr, "[audio] output stream open failed: %s\n",
                      Pa_GetErrorText(err));
@@ -44,6 +52,14 @@ bool AudioIO::open(const AudioConfig& cfg) {
     }
 
     // --- input stream ---
+    // In callback mode the stream feeds a fixed-size ring that a consumer
+    // drains, so capture length no longer dictates memory use.
+    PaStreamCallback* in_callback = nullptr;
+    if (cfg_.capture_mode == CaptureMode::Callback) {
+        ring_ = std::make_unique<SpscRingBuffer<float>>(cfg_.ring_frames);
+        in_callback = &AudioIO::input_callback;
+    }
+
     PaStreamParameters in_params{};
     in_params.device = (cfg_.input_device >= 0)
                            ? cfg_.input_device
@@ -55,7 +71,7 @@ bool AudioIO::open(const AudioConfig& cfg) {
 
     err = Pa_OpenStream(&input_stream_, &in_params, nullptr,
                         cfg_.sample_rate, paFramesPerBufferUnspecified,
-                        paClipOff, nullptr, nullptr);
+                        paClipOff, in_callback, this);
     if (err != paNoError) {
         std::fprintf(stderr, "[audio] input stream open failed: %s\n",
                      Pa_GetErrorText(err));
@@ -67,6 +83,9 @@ bool AudioIO::open(const AudioConfig& cfg) {
 }
 
 void AudioIO::close() {
+    stop_transmit();
+    stop_capture();
+    if (input_running_) { Pa_StopStream(input_stream_); input_running_ = false; }
     if (output_stream_) { Pa_CloseStream(output_stream_); output_stream_ = nullptr; }
     if (input_stream_)  { Pa_CloseStream(input_stream_);  input_stream_  = nullptr; }
     if (initialized_)   { Pa_Terminate(); initialized_ = false; }
@@ -76,19 +95,85 @@ void AudioIO::close() {
 // Transmit
 // ---------------------------------------------------------------------------
 
-bool AudioIO::transmit(const std::vector<int8_t>& timing) {
-    if (!output_stream_) return false;
+bool AudioIO::transmit(const std::vector<int8_t>& timing,
+                       const ProgressCallback& on_progress) {
+    return start_transmit(timing) && wait_transmit(on_progress);
+}
+
+bool AudioIO::start_transmit(std::vector<int8_t> timing) {
+    if (!output_stream_ || !synth_ || tx_running_) return false;
 
-    std::vector<float> pcm = render_tone(timing);
+    tx_timing_ = std::move(timing);
+    tx_cursor_ = {};
+    tx_total_  = synth_->length(tx_timing_);
+    tx_samples_.store(0, std::memory_order_relaxed);
 
     PaError err = Pa_StartStream(output_stream_);
-    if (err != paNoError) return false;
+    if (err != paNoError) {
+        std::fprintf(stderr, "[audio] output stream start failed: %s\n",
+                     Pa_GetErrorText(err));
+        return false;
+    }
+    tx_running_ = true;
+    return true;
+}
 
-    err = Pa_WriteStream(output_stream_, pcm.data(),
-                         static_cast<unsigned long>(pcm.size()));
+bool AudioIO::wait_transmit(const ProgressCallback& on_progress) {
+    if (!tx_running_) return false;
+
+    // The callback returns paComplete after the last sample; the stream
+    // goes inactive once that buffer has played.
+    PaError active;
+    while ((active = Pa_IsStreamActive(output_stream_)) == 1) {
+        if (on_progress) on_progress(transmit_progress());
+        std::this_thread::sleep_for(kProgressInterval);
+    }
 
     Pa_StopStream(output_stream_);
-    return err == paNoError;
+    tx_running_ = false;
+    if (on_progress) on_progress(transmit_progress());
+    return active == 0 &&
+           tx_samples_.load(std::memory_order_acquire) == tx_total_;
+}
+
+void AudioIO::stop_transmit() {
+    if (!tx_running_) return;
+    Pa_AbortStream(output_stream_);
+    tx_running_ = false;
+}
+
+TransmitProgress AudioIO::transmit_progress() const {
+    TransmitProgress progress;
+    const uint64_t done = tx_samples_.load(std::memory_order_acquire);
+    const std::size_t spu = synth_ ? synth_->samples_per_unit() : 0;
+
+    progress.active      = tx_running_;
+    progress.units_total = tx_timing_.size();
+    progress.units_sent  = spu ? std::min<std::size_t>(done / spu, tx_timing_.size()) : 0;
+    progress.elapsed_s   = static_cast<double>(done) / cfg_.sample_rate;
+    progress.remaining_s = static_cast<double>(tx_total_ - std::min(done, tx_total_)) /
+                           cfg_.sample_rate;
+    progress.underflows  = output_underflows_.load(std::memory_order_relaxed);
+    return progress;
+}
+
+int AudioIO::output_callback(const void* /*input*/, void* output,
+                             unsigned long frames,
+                             const PaStreamCallbackTimeInfo* /*time_info*/,
+                             PaStreamCallbackFlags status, void* user_data) {
+    auto* self = static_cast<AudioIO*>(user_data);
+    auto* out  = static_cast<float*>(output);
+
+    if (status & paOutputUnderflow) {
+        self->output_underflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Real-time thread: templates are prebuilt, so this is copies and fills.
+    std::size_t n = self->synth_->render_next(self->tx_timing_, self->tx_cursor_,
+                                              out, frames);
+    std::memset(out + n, 0, (frames - n) * sizeof(float));
+    self->tx_samples_.store(self->tx_cursor_.samples, std::memory_order_release);
+    return n < frames ? paComplete : paContinue;
 }
 
 // ---------------------------------------------------------------------------
@@ -99,6 +184,17 @@ std::vector<float> AudioIO::capture(double duration_sec) {
     if (!input_stream_) return {};
 
     auto num_frames = static_cast<unsigned long>(cfg_.sample_rate * duration_sec);
+
+    if (cfg_.capture_mode == CaptureMode::Callback) {
+        std::vector<float> buf;
+        buf.reserve(num_frames);
+        const bool ok = capture(duration_sec, [&](const float* samples, std::size_t count) {
+            buf.insert(buf.end(), samples, samples + count);
+        });
+        if (!ok) return {};
+        return buf;
+    }
+
     std::vector<float> buf(num_frames, 0.0f);
 
     PaError err = Pa_StartStream(input_stream_);
@@ -110,6 +206,156 @@ std::vector<float> AudioIO::capture(double duration_sec) {
     return buf;
 }
 
+bool AudioIO::capture(double duration_sec, const SampleCallback& on_samples) {
+    if (!input_stream_) return false;
+
+    auto remaining = static_cast<unsigned long>(cfg_.sample_rate * duration_sec);
+
+    if (cfg_.capture_mode == CaptureMode::Callback) {
+        if (consuming_ || !ensure_input_running()) return false;
+        std::atomic<bool> keep_going{true};
+        if (drain(remaining, on_samples, keep_going) < remaining) {
+            // The device is gone: start the stream afresh next time.
+            Pa_AbortStream(input_stream_);
+            input_running_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<float> chunk(kCaptureChunkFrames, 0.0f);
+
+    PaError err = Pa_StartStream(input_stream_);
+    if (err != paNoError) return false;
+
+    while (remaining > 0) {
+        unsigned long n = std::min<unsigned long>(remaining, kCaptureChunkFrames);
+        err = Pa_ReadStream(input_stream_, chunk.data(), n);
+        if (err != paNoError && err != paInputOverflowed) break;
+        on_samples(chunk.data(), n);
+        remaining -= n;
+    }
+
+    Pa_StopStream(input_stream_);
+    return remaining == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Callback capture
+// ---------------------------------------------------------------------------
+
+int AudioIO::input_callback(const void* input, void* /*output*/,
+                            unsigned long frames,
+                            const PaStreamCallbackTimeInfo* /*time_info*/,
+                            PaStreamCallbackFlags status, void* user_data) {
+    auto* self = static_cast<AudioIO*>(user_data);
+
+    if (status & paInputOverflow) {
+        self->input_overflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!input) return paContinue;
+
+    // Real-time thread: no locks, no allocation — drop what does not fit.
+    std::size_t written =
+        self->ring_->write(static_cast<const float*>(input), frames);
+    if (written < frames) {
+        self->overruns_.fetch_add(1, std::memory_order_relaxed);
+        self->dropped_frames_.fetch_add(frames - written, std::memory_order_relaxed);
+    }
+
+    std::size_t fill = self->ring_->size();
+    if (fill > self->high_water_.load(std::memory_order_relaxed)) {
+        self->high_water_.store(fill, std::memory_order_relaxed);
+    }
+    return paContinue;
+}
+
+bool AudioIO::ensure_input_running() {
+    if (!ring_ || !input_stream_) return false;
+    if (input_running_) return true;
+
+    PaError err = Pa_StartStream(input_stream_);
+    if (err != paNoError) {
+        std::fprintf(stderr, "[audio] input stream start failed: %s\n",
+                     Pa_GetErrorText(err));
+        return false;
+    }
+    input_running_ = true;
+    return true;
+}
+
+uint64_t AudioIO::drain(uint64_t max_frames, const SampleCallback& on_samples,
+                        const std::atomic<bool>& keep_going) {
+    std::vector<float> chunk(kCaptureChunkFrames);
+
+    // Poll at half a chunk period: often enough that the ring stays near
+    // empty, rarely enough to cost nothing.
+    const auto idle = std::chrono::microseconds(static_cast<long>(
+        0.5e6 * static_cast<double>(kCaptureChunkFrames) / cfg_.sample_rate));
+
+    const auto stall = idle * (2 * kStallChunks);
+    const auto dead  = stall * kDeadStalls;
+
+    uint64_t delivered = 0;
+    auto last_audio = std::chrono::steady_clock::now();
+    bool stalled = false;   // this wait already counted
+    while (delivered < max_frames && keep_going.load(std::memory_order_relaxed)) {
+        auto want = static_cast<std::size_t>(
+            std::min<uint64_t>(chunk.size(), max_frames - delivered));
+        std::size_t n = ring_->read(chunk.data(), want);
+        if (n == 0) {
+            const auto waited = std::chrono::steady_clock::now() - last_audio;
+            if (waited > stall) {
+                if (!stalled) stalls_.fetch_add(1, std::memory_order_relaxed);
+                stalled = true;
+                // A stream that stopped calling back never refills the ring.
+                if (Pa_IsStreamActive(input_stream_) != 1 || waited > dead) {
+                    std::fprintf(stderr, "[audio] input stopped delivering after %llu frames\n",
+                                 static_cast<unsigned long long>(delivered));
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(idle);
+            continue;
+        }
+        last_audio = std::chrono::steady_clock::now();
+        stalled = false;
+        on_samples(chunk.data(), n);
+        delivered += n;
+    }
+    return delivered;
+}
+
+bool AudioIO::start_capture(SampleCallback on_samples) {
+    if (cfg_.capture_mode != CaptureMode::Callback) {
+        std::fprintf(stderr, "[audio] continuous capture needs callback mode\n");
+        return false;
+    }
+    if (consuming_ || !ensure_input_running()) return false;
+
+    consuming_ = true;
+    consumer_ = std::thread([this, cb = std::move(on_samples)] {
+        drain(std::numeric_limits<uint64_t>::max(), cb, consuming_);
+    });
+    return true;
+}
+
+void AudioIO::stop_capture() {
+    consuming_ = false;
+    if (consumer_.joinable()) consumer_.join();
+}
+
+CaptureStats AudioIO::capture_stats() const {
+    CaptureStats stats;
+    stats.overruns        = overruns_.load(std::memory_order_relaxed);
+    stats.dropped_frames  = dropped_frames_.load(std::memory_order_relaxed);
+    stats.stalls          = stalls_.load(std::memory_order_relaxed);
+    stats.input_overflows = input_overflows_.load(std::memory_order_relaxed);
+    stats.high_water      = high_water_.load(std::memory_order_relaxed);
+    stats.capacity        = ring_ ? ring_->capacity() : 0;
+    return stats;
+}
+
 // ---------------------------------------------------------------------------
 // Helpers
 // ---------------------------------------------------------------------------
@@ -132,28 +378,4 @@ void AudioIO::list_devices() {
     Pa_Terminate();
 }
 
-std::vector<float> AudioIO::render_tone(const std::vector<int8_t>& timing) const {
-    const double unit_sec = unit_duration(cfg_.wpm);
-    const auto   samples_per_unit =
-        static_cast<std::size_t>(cfg_.sample_rate * unit_sec);
-
-    std::vector<float> pcm;
-    pcm.reserve(timing.size() * samples_per_unit);
-
-    const double omega = 2.0 * M_PI * cfg_.tone_freq_hz / cfg_.sample_rate;
-    std::size_t  sample_idx = 0;
-
-    for (int8_t t : timing) {
-        for (std::size_t s = 0; s < samples_per_unit; ++s, ++sample_idx) {
-            if (t > 0) {
-                pcm.push_back(static_cast<float>(
-                    0.8 * std::sin(omega * static_cast<double>(sample_idx))));
-            } else {
-                pcm.push_back(0.0f);
-            }
-        }
-    }
-    return pcm;
-}
-
 } // namespace btccw::node
@@ -0,0 +1,247 @@
+#include "base43_codec.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace btccw::node {
+
+namespace {
+
+/// Little-endian limbs of a natural number, each below the radix.
+using Limbs = std::vector<uint32_t>;
+
+constexpr uint64_t kByteRadix   = uint64_t{1} << 32;   // four bytes per limb
+constexpr uint64_t kDigitRadix  = 147008443;           // 43^5: five digits per limb
+constexpr int      kDigitsPerLimb = 5;
+
+/// Below this many limbs Karatsuba's extra additions cost more than its
+/// saved products.
+constexpr std::size_t kKaratsubaLimbs = 32;
+
+/// Source limbs converted by Horner's rule rather than split further.
+constexpr std::size_t kLeafLimbs = 32;
+
+void trim(Limbs& x) {
+    while (!x.empty() && x.back() == 0) x.pop_back();
+}
+
+/// Arithmetic on limbs in radix R. Every product fits 64 bits: a limb
+/// times a limb plus two limbs is at most R^2 - 1.
+template <uint64_t R>
+struct Arith {
+    /// x = x * s + add, for a scalar s with (R - 1) * s + R < 2^64.
+    static void mul_small_add(Limbs& x, uint64_t s, uint64_t add) {
+        uint64_t carry = add;
+        for (auto& limb : x) {
+            const uint64_t t = limb * s + carry;
+            limb  = static_cast<uint32_t>(t % R);
+            carry = t / R;
+        }
+        for (; carry; carry /= R) x.push_back(static_cast<uint32_t>(carry % R));
+    }
+
+    /// acc += x * R^shift.
+    static void add_shifted(Limbs& acc, const uint32_t* x, std::size_t n, std::size_t shift) {
+        if (acc.size() < shift + n) acc.resize(shift + n, 0);
+        uint64_t carry = 0;
+        std::size_t i = 0;
+        for (; i < n; ++i) {
+            const uint64_t t = uint64_t{acc[shift + i]} + x[i] + carry;
+            acc[shift + i] = static_cast<uint32_t>(t % R);
+            carry = t / R;
+        }
+        for (std::size_t k = shift + i; carry; ++k) {
+            if (k == acc.size()) acc.push_back(0);
+            const uint64_t t = uint64_t{acc[k]} + carry;
+            acc[k] = static_cast<uint32_t>(t % R);
+            carry  = t / R;
+        }
+    }
+
+    /// a -= b, for a >= b.
+    static void sub(Limbs& a, const Limbs& b) {
+        uint64_t borrow = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            const uint64_t take = (i < b.size() ? b[i] : 0) + borrow;
+            if (a[i] >= take) {
+                a[i] = static_cast<uint32_t>(a[i] - take);
+                borrow = 0;
+            } else {
+                a[i] = static_cast<uint32_t>(a[i] + R - take);
+                borrow = 1;
+            }
+            if (i >= b.size() && !borrow) break;
+        }
+    }
+
+    static Limbs schoolbook(const uint32_t* a, std::size_t na, const uint32_t* b, std::size_t nb) {
+        Limbs r(na + nb, 0);
+        for (std::size_t i = 0; i < na; ++i) {
+            uint64_t carry = 0;
+            for (std::size_t j = 0; j < nb; ++j) {
+                const uint64_t t = uint64_t{r[i + j]} + uint64_t{a[i]} * b[j] + carry;
+                r[i + j] = static_cast<uint32_t>(t % R);
+                carry    = t / R;
+            }
+            r[i + nb] = static_cast<uint32_t>(carry);
+        }
+        return r;
+    }
+
+    static Limbs mul(const uint32_t* a, std::size_t na, const uint32_t* b, std::size_t nb) {
+        if (na < nb) {
+            std::swap(a, b);
+            std::swap(na, nb);
+        }
+        if (nb == 0) return {};
+        if (nb < kKaratsubaLimbs) return schoolbook(a, na, b, nb);
+
+        const std::size_t h = na / 2;
+        if (nb <= h) {
+            // Lopsided: split the long factor only.
+            Limbs r = mul(a, h, b, nb);
+            const Limbs hi = mul(a + h, na - h, b, nb);
+            add_shifted(r, hi.data(), hi.size(), h);
+            return r;
+        }
+
+        // (a1 R^h + a0)(b1 R^h + b0)
+        //   = z2 R^2h + ((a0 + a1)(b0 + b1) - z2 - z0) R^h + z0
+        const Limbs z0 = mul(a, h, b, h);
+        const Limbs z2 = mul(a + h, na - h, b + h, nb - h);
+        Limbs sa(a, a + h);
+        add_shifted(sa, a + h, na - h, 0);
+        Limbs sb(b, b + h);
+        add_shifted(sb, b + h, nb - h, 0);
+        Limbs z1 = mul(sa.data(), sa.size(), sb.data(), sb.size());
+        sub(z1, z0);
+        sub(z1, z2);
+
+        Limbs r = z0;
+        add_shifted(r, z1.data(), z1.size(), h);
+        add_shifted(r, z2.data(), z2.size(), 2 * h);
+        return r;
+    }
+};
+
+/// Converts little-endian radix-S limbs to radix-R limbs.
+template <uint64_t S, uint64_t R>
+class Converter {
+public:
+    Limbs convert(const uint32_t* src, std::size_t n) {
+        if (n <= kLeafLimbs) {
+            Limbs acc;
+            for (std::size_t i = n; i-- > 0;) Arith<R>::mul_small_add(acc, S, src[i]);
+            return acc;
+        }
+        // The low part is kLeafLimbs * 2^k source limbs, the largest such
+        // below n, so every split at a level shares one power.
+        std::size_t k = 0;
+        while ((kLeafLimbs << (k + 1)) < n) ++k;
+        const std::size_t m = kLeafLimbs << k;
+
+        const Limbs  low  = convert(src, m);
+        const Limbs  high = convert(src + m, n - m);
+        const Limbs& base = power(k);
+        Limbs r = Arith<R>::mul(high.data(), high.size(), base.data(), base.size());
+        Arith<R>::add_shifted(r, low.data(), low.size(), 0);
+        trim(r);
+        return r;
+    }
+
+private:
+    std::vector<Limbs> powers_;   // powers_[k] = S^(kLeafLimbs * 2^k) in radix R
+
+    const Limbs& power(std::size_t k) {
+        if (powers_.empty()) {
+            Limbs p{1};
+            for (std::size_t i = 0; i < kLeafLimbs; ++i) Arith<R>::mul_small_add(p, S, 0);
+            powers_.push_back(std::move(p));
+        }
+        while (powers_.size() <= k) {
+            const Limbs& last = powers_.back();
+            Limbs next = Arith<R>::mul(last.data(), last.size(), last.data(), last.size());
+            trim(next);
+            powers_.push_back(std::move(next));
+        }
+        return powers_[k];
+    }
+};
+
+constexpr const char* kAlphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ +/.:-?";
+
+/// Digit value of each character, -1 outside the alphabet.
+constexpr std::array<int8_t, 256> make_digits() {
+    std::array<int8_t, 256> t{};
+    for (auto& d : t) d = -1;
+    for (int i = 0; kAlphabet[i]; ++i) t[static_cast<unsigned char>(kAlphabet[i])] = static_cast<int8_t>(i);
+    return t;
+}
+
+constexpr std::array<int8_t, 256> kDigits = make_digits();
+
+} // namespace
+
+std::string Base43Codec::encode(const std::vector<uint8_t>& bytes) {
+    std::size_t zeros = 0;
+    while (zeros < bytes.size() && bytes[zeros] == 0) ++zeros;
+
+    // Four bytes per limb, grouped from the least significant end.
+    const std::size_t n = bytes.size() - zeros;
+    Limbs src((n + 3) / 4, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        src[i / 4] |= uint32_t{bytes[bytes.size() - 1 - i]} << (8 * (i % 4));
+    }
+    const Limbs digits = Converter<kByteRadix, kDigitRadix>().convert(src.data(), src.size());
+
+    std::string out(zeros, '0');
+    out.reserve(zeros + digits.size() * kDigitsPerLimb);
+    for (std::size_t i = digits.size(); i-- > 0;) {
+        char group[kDigitsPerLimb];
+        uint32_t v = digits[i];
+        for (int d = kDigitsPerLimb - 1; d >= 0; --d, v /= 43) group[d] = kAlphabet[v % 43];
+        // The top limb has no leading zeros.
+        int first = 0;
+        if (i + 1 == digits.size()) {
+            while (first < kDigitsPerLimb - 1 && group[first] == '0') ++first;
+        }
+        out.append(group + first, group + kDigitsPerLimb);
+    }
+    return out;
+}
+
+std::vector<uint8_t> Base43Codec::decode(std::string_view text) {
+    std::size_t zeros = 0;
+    while (zeros < text.size() && text[zeros] == '0') ++zeros;
+
+    // Five digits per limb, grouped from the least significant end.
+    const std::size_t n = text.size() - zeros;
+    Limbs src((n + kDigitsPerLimb - 1) / kDigitsPerLimb, 0);
+    for (std::size_t limb = 0; limb < src.size(); ++limb) {
+        const std::size_t end   = text.size() - limb * kDigitsPerLimb;
+        const std::size_t begin = end - std::min<std::size_t>(kDigitsPerLimb, end - zeros);
+        uint32_t v = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const int symbol = kDigits[static_cast<unsigned char>(text[i])];
+            if (symbol < 0) return {};
+            v = v * 43 + static_cast<uint32_t>(symbol);
+        }
+        src[limb] = v;
+    }
+    const Limbs value = Converter<kDigitRadix, kByteRadix>().convert(src.data(), src.size());
+
+    std::vector<uint8_t> out(zeros, 0);
+    out.reserve(zeros + value.size() * 4);
+    bool leading = true;
+    for (std::size_t i = value.size(); i-- > 0;) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            const auto b = static_cast<uint8_t>(value[i] >> shift);
+            if (leading && b == 0) continue;
+            leading = false;
+            out.push_back(b);
+        }
+    }
+    return out;
+}
+
+} // namespace btccw::node
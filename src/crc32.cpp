@@ -0,0 +1,255 @@
+#include "crc32.hpp"
+
+#include <array>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BTCCW_CRC32_X86 1
+#include <immintrin.h>
+#endif
+
+namespace btccw::node {
+
+namespace {
+
+constexpr uint32_t kPoly = 0xEDB88320u;   // reflected 0x04C11DB7
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+/// tables[0] is the byte-at-a-time table; tables[k][i] is the CRC of byte
+/// i followed by k zero bytes, which is what slicing-by-8 looks up.
+constexpr CrcTables make_tables() {
+    CrcTables t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1u) ? (c >> 1) ^ kPoly : c >> 1;
+        t[0][i] = c;
+    }
+    for (std::size_t k = 1; k < 8; ++k) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFFu];
+        }
+    }
+    return t;
+}
+
+constexpr CrcTables kTables = make_tables();
+
+inline uint32_t load_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+/// The raw register (no inversions) over `len` bytes, eight at a time.
+uint32_t slice8(uint32_t state, const uint8_t* p, std::size_t len) {
+    for (; len >= 8; p += 8, len -= 8) {
+        const uint32_t lo = load_le32(p) ^ state;
+        const uint32_t hi = load_le32(p + 4);
+        state = kTables[7][lo & 0xFFu] ^ kTables[6][(lo >> 8) & 0xFFu] ^
+                kTables[5][(lo >> 16) & 0xFFu] ^ kTables[4][lo >> 24] ^
+                kTables[3][hi & 0xFFu] ^ kTables[2][(hi >> 8) & 0xFFu] ^
+                kTables[1][(hi >> 16) & 0xFFu] ^ kTables[0][hi >> 24];
+    }
+    for (; len > 0; ++p, --len) state = kTables[0][(state ^ *p) & 0xFFu] ^ (state >> 8);
+    return state;
+}
+
+// ---------------------------------------------------------------------------
+// GF(2) polynomial arithmetic mod P, for combine()
+// ---------------------------------------------------------------------------
+
+/// a * b mod P, both reflected (bit 31 is x^0).
+uint32_t multmodp(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) {
+            product ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        b = (b & 1u) ? (b >> 1) ^ kPoly : b >> 1;
+    }
+    return product;
+}
+
+/// x^(2^k) mod P for k = 0..31, by repeated squaring.
+const std::array<uint32_t, 32>& x2n_table() {
+    static const std::array<uint32_t, 32> table = [] {
+        std::array<uint32_t, 32> t{};
+        uint32_t p = 1u << 30;   // x^1
+        for (auto& entry : t) {
+            entry = p;
+            p = multmodp(p, p);
+        }
+        return t;
+    }();
+    return table;
+}
+
+/// x^(8 * bytes) mod P: the factor that moves a CRC past `bytes` bytes.
+uint32_t shift_for(std::size_t bytes) {
+    const auto& x2n = x2n_table();
+    uint32_t p = 1u << 31;   // x^0
+    unsigned k = 3;          // 8 * bytes = bytes * 2^3
+    for (uint64_t n = bytes; n; n >>= 1, ++k) {
+        if (n & 1) p = multmodp(x2n[k & 31], p);
+    }
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// PCLMULQDQ folding
+// ---------------------------------------------------------------------------
+
+#ifdef BTCCW_CRC32_X86
+
+/// Folding constants for the reflected polynomial: x^(4*128+32) and
+/// x^(4*128-32) mod P (four blocks apart), x^(128+32) and x^(128-32) (one
+/// block), x^64 for the 64-bit step, then P and its Barrett quotient.
+alignas(16) constexpr uint64_t kFold4[2]   = {0x0154442bd4, 0x01c6e41596};
+alignas(16) constexpr uint64_t kFold1[2]   = {0x01751997d0, 0x00ccaa009e};
+alignas(16) constexpr uint64_t kFold64[2]  = {0x0163cd6124, 0x0000000000};
+alignas(16) constexpr uint64_t kBarrett[2] = {0x01db710641, 0x01f7011641};
+
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i load(const uint8_t* at) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+}
+
+/// acc moved 128 bits along (by the constant pair in k), plus next.
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i fold(__m128i acc, __m128i next, __m128i k) {
+    const __m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);
+    const __m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+/// The raw register over `len` bytes, len >= 64 and a multiple of 16.
+__attribute__((target("pclmul,sse4.1")))
+uint32_t fold_pclmul(uint32_t state, const uint8_t* p, std::size_t len) {
+    __m128i x1 = _mm_xor_si128(load(p), _mm_cvtsi32_si128(static_cast<int>(state)));
+    __m128i x2 = load(p + 16);
+    __m128i x3 = load(p + 32);
+    __m128i x4 = load(p + 48);
+    p   += 64;
+    len -= 64;
+
+    // Four independent lanes, each folded 64 bytes ahead per step.
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(kFold4));
+    for (; len >= 64; p += 64, len -= 64) {
+        x1 = fold(x1, load(p), k);
+        x2 = fold(x2, load(p + 16), k);
+        x3 = fold(x3, load(p + 32), k);
+        x4 = fold(x4, load(p + 48), k);
+    }
+
+    // Fold the four lanes into one, then the remaining 16-byte blocks.
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(kFold1));
+    x1 = fold(x1, x2, k);
+    x1 = fold(x1, x3, k);
+    x1 = fold(x1, x4, k);
+    for (; len >= 16; p += 16, len -= 16) x1 = fold(x1, load(p), k);
+
+    // 128 bits to 64.
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x0 = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x0);
+    k  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(kFold64));
+    x0 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x0);
+
+    // Barrett reduction to 32 bits.
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(kBarrett));
+    x0 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+    x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x0);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t update_pclmul(uint32_t crc, const void* data, std::size_t len) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint32_t state = ~crc;
+    if (len >= 64) {
+        const std::size_t folded = len & ~std::size_t{15};
+        state = fold_pclmul(state, p, folded);
+        p   += folded;
+        len -= folded;
+    }
+    return ~slice8(state, p, len);
+}
+
+#endif // BTCCW_CRC32_X86
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+using UpdateFn = uint32_t (*)(uint32_t, const void*, std::size_t);
+
+struct CrcImpl {
+    const char* name;
+    UpdateFn    update;
+};
+
+#ifdef BTCCW_CRC32_X86
+bool has_pclmul() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+#endif
+
+CrcImpl select_impl() {
+#ifdef BTCCW_CRC32_X86
+    if (has_pclmul()) return {"pclmul", &update_pclmul};
+#endif
+    return {"slice8", &Crc32::update_slice8};
+}
+
+CrcImpl& impl() {
+    static CrcImpl selected = select_impl();
+    return selected;
+}
+
+} // namespace
+
+uint32_t Crc32::update_bytewise(uint32_t crc, const void* data, std::size_t len) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    uint32_t state = ~crc;
+    for (std::size_t i = 0; i < len; ++i) state = kTables[0][(state ^ p[i]) & 0xFFu] ^ (state >> 8);
+    return ~state;
+}
+
+uint32_t Crc32::update_slice8(uint32_t crc, const void* data, std::size_t len) {
+    return ~slice8(~crc, static_cast<const uint8_t*>(data), len);
+}
+
+uint32_t Crc32::update(uint32_t crc, const void* data, std::size_t len) {
+    return impl().update(crc, data, len);
+}
+
+uint32_t Crc32::combine(uint32_t crc_a, uint32_t crc_b, std::size_t len_b) {
+    return multmodp(shift_for(len_b), crc_a) ^ crc_b;
+}
+
+Crc32::Combiner::Combiner(std::size_t len_b) : shift_(shift_for(len_b)) {}
+
+uint32_t Crc32::Combiner::operator()(uint32_t crc_a, uint32_t crc_b) const {
+    return multmodp(shift_, crc_a) ^ crc_b;
+}
+
+const char* Crc32::name() { return impl().name; }
+
+bool Crc32::force(std::string_view name) {
+    if (name == "slice8") {
+        impl() = {"slice8", &Crc32::update_slice8};
+        return true;
+    }
+#ifdef BTCCW_CRC32_X86
+    if (name == "pclmul" && has_pclmul()) {
+        impl() = {"pclmul", &update_pclmul};
+        return true;
+    }
+#endif
+    return false;
+}
+
+} // namespace btccw::node
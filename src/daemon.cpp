@@ -0,0 +1,86 @@
+#include "daemon.hpp"
+
+#include <cstdio>
+
+namespace btccw::node {
+
+Daemon::Daemon(NodeEngine& engine, const DaemonConfig& cfg)
+    : engine_(engine), cfg_(cfg), queue_(cfg.queue_depth) {}
+
+Daemon::~Daemon() { stop(); }
+
+bool Daemon::start() {
+    if (running_) return false;
+
+    worker_ = std::thread([this] { broadcast_loop(); });
+    if (!engine_.start_listening([this](const DecodeResult& r) { on_frame(r); })) {
+        queue_.close();
+        worker_.join();
+        return false;
+    }
+    running_ = true;
+    return true;
+}
+
+void Daemon::stop() {
+    if (!running_) return;
+    running_ = false;
+
+    // Upstream first: once the decoder is flushed nothing more is pushed.
+    engine_.stop_listening();
+    queue_.close();
+    if (worker_.joinable()) worker_.join();
+}
+
+DaemonStats Daemon::stats() const {
+    DaemonStats stats;
+    stats.frames       = frames_.load(std::memory_order_relaxed);
+    stats.transactions = transactions_.load(std::memory_order_relaxed);
+    stats.dropped      = dropped_.load(std::memory_order_relaxed);
+    stats.broadcast    = broadcast_.load(std::memory_order_relaxed);
+    stats.failed       = failed_.load(std::memory_order_relaxed);
+    stats.queued       = queue_.size();
+    return stats;
+}
+
+void Daemon::on_frame(const DecodeResult& result) {
+    frames_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!result.success) {
+        if (result.fragment.count > 0) {
+            std::printf("[daemon] TX %s: fragment %zu of %zu\n",
+                        result.fragment.tx_id.c_str(), result.fragment.index,
+                        result.fragment.count);
+        } else {
+            std::fprintf(stderr, "[daemon] frame failed: %s\n", result.error.c_str());
+        }
+        return;
+    }
+
+    transactions_.fetch_add(1, std::memory_order_relaxed);
+    std::printf("[daemon] decoded TX (%.0f WPM), %zu bytes\n",
+                result.wpm, result.raw_bytes.size());
+    if (!queue_.try_push(result.hex_string)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        std::fprintf(stderr, "[daemon] broadcast queue full (%zu); TX dropped\n",
+                     queue_.capacity());
+    }
+    std::fflush(stdout);
+}
+
+void Daemon::broadcast_loop() {
+    std::string hex;
+    while (queue_.pop(hex)) {
+        std::string txid = engine_.broadcast(hex);
+        if (txid.empty()) {
+            failed_.fetch_add(1, std::memory_order_relaxed);
+            std::fprintf(stderr, "[daemon] broadcast failed\n");
+        } else {
+            broadcast_.fetch_add(1, std::memory_order_relaxed);
+            std::printf("[daemon] broadcast txid: %s\n", txid.c_str());
+        }
+        std::fflush(stdout);
+    }
+}
+
+} // namespace btccw::node
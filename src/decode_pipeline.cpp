@@ -1,27 +1,72 @@
 #include "decode_pipeline.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
-#include <btccw/base43.hpp>
 #include <btccw/transaction.hpp>
 
 #include "audio_io.hpp"
+#include "base43_codec.hpp"
 
 namespace btccw::node {
 
+namespace {
+
+DecodeConfig make_config(double sample_rate, double tone_freq, int wpm,
+                         std::size_t block_size, double threshold) {
+    DecodeConfig cfg;
+    cfg.sample_rate = sample_rate;
+    cfg.tone_freq   = tone_freq;
+    cfg.wpm         = wpm;
+    cfg.block_size  = block_size;
+    cfg.threshold   = threshold;
+    return cfg;
+}
+
+/// Adaptive tracker span in decisions (hops).
+std::size_t noise_window(const DecodeConfig& cfg) {
+    std::size_t hop = (cfg.hop_size == 0 || cfg.hop_size > cfg.block_size)
+                          ? cfg.block_size : cfg.hop_size;
+    if (hop == 0) return GoertzelDetector::kNoiseWindow;
+    return static_cast<std::size_t>(
+        std::max(1.0, std::round(cfg.noise_window_s * cfg.sample_rate /
+                                 static_cast<double>(hop))));
+}
+
+} // namespace
+
 DecodePipeline::DecodePipeline(double sample_rate, double tone_freq, int wpm,
                                std::size_t block_size, double threshold)
-    : detector_(sample_rate, tone_freq, block_size, threshold),
+    : DecodePipeline(make_config(sample_rate, tone_freq, wpm, block_size,
+                                 threshold)) {}
+
+DecodePipeline::DecodePipeline(const DecodeConfig& cfg)
+    : cfg_(cfg),
+      detector_(cfg.sample_rate, cfg.tone_freq, cfg.block_size, cfg.threshold,
+                cfg.hop_size, cfg.threshold_mode, noise_window(cfg)),
+      bank_(cfg.sample_rate, cfg.channel_freqs, cfg.block_size, cfg.threshold,
+            cfg.hop_size, cfg.threshold_mode, noise_window(cfg)),
+      // Morse timing is counted in decisions, i.e. hops, not blocks.
       morse_decoder_(static_cast<int>(
-          std::round(AudioIO::unit_duration(wpm) * sample_rate /
-                     static_cast<double>(block_size)))) {}
+                         std::round(AudioIO::unit_duration(cfg.wpm) * cfg.sample_rate /
+                                    static_cast<double>(detector_.hop_size()))),
+                     cfg.auto_wpm),
+      soft_decoder_(morse_decoder_, cfg.soft_beam, cfg.soft_candidates) {}
+
+double DecodePipeline::unit_to_wpm(double unit) const noexcept {
+    if (unit <= 0.0 || detector_.hop_size() == 0) return 0.0;
+    // PARIS timing: one unit is 1.2 / wpm seconds.
+    return 1.2 * cfg_.sample_rate / (unit * static_cast<double>(detector_.hop_size()));
+}
 
 DecodeResult DecodePipeline::decode(const std::vector<float>& pcm) const {
     DecodeResult result;
 
     // Stage 1: Goertzel tone detection.
     result.stage_reached = DecodeStage::Goertzel;
-    result.tone_bits = detector_.detect(pcm);
+    std::vector<double> mags = detector_.magnitudes(pcm);
+    result.tone_bits = detector_.decide(mags);
     if (result.tone_bits.empty()) {
         result.error = "Goertzel: no blocks to analyze";
         return result;
@@ -29,42 +74,169 @@ DecodeResult DecodePipeline::decode(const std::vector<float>& pcm) const {
 
     // Stage 2: Morse decode.
     result.stage_reached = DecodeStage::MorseDecode;
-    result.morse_text = morse_decoder_.decode(result.tone_bits);
+    double unit = 0.0;
+    std::vector<Erasure> erasures;
+    result.morse_text = morse_decoder_.decode(result.tone_bits, &unit, &erasures);
+    result.wpm = unit_to_wpm(unit);
     if (result.morse_text.empty()) {
         result.error = "Morse decode: no text recovered";
-        return result;
+    } else {
+        // Leading noise or a second transmission may surround the frame:
+        // take the first one that carries a transaction (or a fragment).
+        // With none, deframing the whole text reports why.
+        auto frames = decode_frames(result.morse_text, erasures);
+        auto it = std::find_if(frames.begin(), frames.end(), [](const DecodeResult& f) {
+            return f.success || f.fragment.count > 0;
+        });
+        DecodeResult framed = it != frames.end() ? std::move(*it)
+                              : !frames.empty()  ? std::move(frames.front())
+                                                 : decode_frame(result.morse_text, erasures);
+        framed.tone_bits = std::move(result.tone_bits);
+        framed.wpm = result.wpm;
+        result = std::move(framed);
     }
 
+    // Hard decisions failed somewhere: search the magnitudes instead.
+    if (!result.success && result.fragment.count == 0) soft_decode(mags, unit, result);
+    return result;
+}
+
+bool DecodePipeline::soft_decode(const std::vector<double>& mags, double unit,
+                                 DecodeResult& result) const {
+    if (cfg_.soft_candidates == 0) return false;
+
+    for (const auto& candidate :
+         soft_decoder_.decode(mags, unit, detector_.noise_window())) {
+        // A candidate may carry stray characters keyed by noise before or
+        // after the frame, so scan for it.
+        auto frames = decode_frames(candidate.text);
+        auto it = std::find_if(frames.begin(), frames.end(), [](const DecodeResult& f) {
+            return f.success || f.fragment.count > 0;
+        });
+        if (it == frames.end()) continue;
+
+        DecodeResult found  = std::move(*it);
+        found.tone_bits     = std::move(result.tone_bits);
+        found.wpm           = result.wpm;
+        found.soft_decision = true;
+        result = std::move(found);
+        return true;
+    }
+    return false;
+}
+
+std::vector<DecodeResult> DecodePipeline::decode_multi(
+    const std::vector<float>& pcm) const {
+    std::vector<ToneBits>          channels;
+    std::vector<double>            freqs;
+    if (bank_.bins() > 0) {
+        channels = bank_.detect(pcm);
+        freqs    = bank_.freqs();
+    } else {
+        channels.push_back(detector_.detect(pcm));
+        freqs.push_back(cfg_.tone_freq);
+    }
+
+    std::vector<DecodeResult> results;
+    for (std::size_t ch = 0; ch < channels.size(); ++ch) {
+        double unit = 0.0;
+        std::vector<Erasure> erasures;
+        std::string text = morse_decoder_.decode(channels[ch], &unit, &erasures);
+
+        // A channel can carry several transmissions.
+        for (auto& frame : decode_frames(text, erasures)) {
+            // Neighbouring bins hear the same station: keep the first copy.
+            bool seen = false;
+            for (const auto& r : results) seen = seen || r.base43_payload == frame.base43_payload;
+            if (seen) continue;
+            results.push_back(std::move(frame));
+            results.back().tone_freq_hz = freqs[ch];
+            results.back().wpm = unit_to_wpm(unit);
+        }
+    }
+    return results;
+}
+
+DecodeResult DecodePipeline::decode_frame(const std::string& morse_text,
+                                          const std::vector<Erasure>& erasures) const {
+    DecodeResult result;
+    result.morse_text = morse_text;
+
     // Stage 3: Deframe (strip KKK/AR, verify CRC).
     result.stage_reached = DecodeStage::Deframe;
-    auto deframe_result = Deframer::deframe(result.morse_text);
+    auto deframe_result = Deframer::deframe(result.morse_text, erasures);
     if (!deframe_result.valid) {
         result.error = "Deframe: " + deframe_result.error;
         return result;
     }
-    result.base43_payload = deframe_result.payload;
+    DecodeResult payload = decode_payload(deframe_result.payload);
+    payload.morse_text = std::move(result.morse_text);
+    payload.repaired   = deframe_result.repaired;
+    return payload;
+}
+
+std::vector<DecodeResult> DecodePipeline::decode_frames(
+    const std::string& text, const std::vector<Erasure>& erasures) const {
+    std::vector<DecodeResult> results;
+    for (auto& frame : Deframer::scan(text, erasures)) {
+        DecodeResult result = decode_payload(frame.result.payload);
+        result.morse_text = text.substr(frame.begin, frame.end - frame.begin);
+        result.repaired   = frame.result.repaired;
+        results.push_back(std::move(result));
+    }
+    return results;
+}
+
+DecodeResult DecodePipeline::decode_payload(const std::string& base43_payload) const {
+    DecodeResult result;
+    result.base43_payload = base43_payload;
 
     // Stage 4: Base43 decode.
     result.stage_reached = DecodeStage::Base43Decode;
-    result.raw_bytes = btccw::Base43::decode(result.base43_payload);
+    result.raw_bytes = Base43Codec::decode(result.base43_payload);
     if (result.raw_bytes.empty()) {
         result.error = "Base43 decode: invalid encoding";
-        return result;
+    } else {
+        // Stage 5: Convert to hex and validate.
+        result.stage_reached = DecodeStage::Validate;
+        result.hex_string = btccw::Transaction::bytes_to_hex(
+            result.raw_bytes.data(), result.raw_bytes.size());
+        if (btccw::Transaction::validate(result.hex_string)) {
+            result.stage_reached = DecodeStage::Complete;
+            result.success = true;
+            return result;
+        }
+        result.error = "Transaction validation failed";
+    }
+
+    // Not a transaction: maybe one fragment of one.
+    if (Fragmenter::parse(result.base43_payload, result.fragment)) {
+        result.error = "fragment " + std::to_string(result.fragment.index) + "/" +
+                       std::to_string(result.fragment.count) + " of " +
+                       result.fragment.tx_id;
     }
+    return result;
+}
 
-    // Stage 5: Convert to hex and validate.
-    result.stage_reached = DecodeStage::Validate;
-    result.hex_string = btccw::Transaction::bytes_to_hex(
-        result.raw_bytes.data(), result.raw_bytes.size());
+void DecodePipeline::reassemble(Reassembler& reassembler, DecodeResult& result) const {
+    if (result.success || result.fragment.count == 0) return;
 
-    if (!btccw::Transaction::validate(result.hex_string)) {
-        result.error = "Transaction validation failed";
-        return result;
+    ReassemblyStatus status = reassembler.add(result.fragment);
+    if (!status.error.empty()) {
+        result.error += "; " + status.error;
+        return;
     }
+    if (!status.complete) return;
 
-    result.stage_reached = DecodeStage::Complete;
-    result.success = true;
-    return result;
+    // The last fragment completes the transaction: report it as a whole.
+    DecodeResult whole = decode_payload(status.payload);
+    whole.morse_text    = std::move(result.morse_text);
+    whole.tone_freq_hz  = result.tone_freq_hz;
+    whole.wpm           = result.wpm;
+    whole.soft_decision = result.soft_decision;
+    whole.repaired      = result.repaired;
+    whole.fragment      = std::move(result.fragment);
+    result = std::move(whole);
 }
 
 } // namespace btccw::node
@@ -1,16 +1,175 @@
 #include "deframer.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
 #include <btccw/checksum.hpp>
 
+#include "crc32.hpp"
+#include "fec_framer.hpp"
+
 namespace btccw::node {
 
+namespace {
+
+constexpr std::size_t kPrefixLen = 4;  // "KKK "
+constexpr std::size_t kSuffixLen = 3;  // " AR"
+constexpr std::size_t kCrcLen    = 4;
+constexpr const char* kPrefix    = "KKK ";
+constexpr const char* kSuffix    = " AR";
+
+/// Whether Crc32 is the CRC Checksum::crc32() computes; if not, payloads
+/// are hashed whole by the core instead of in pieces.
+bool running_crc_matches_core() {
+    static const bool matches = [] {
+        // Long enough for the 64-byte fold, its 16-byte blocks and a tail.
+        std::string probe;
+        for (int i = 0; i < 199; ++i) probe += static_cast<char>(i * 37 + 11);
+        const std::string_view head = std::string_view(probe).substr(0, 71);
+        const std::string_view tail = std::string_view(probe).substr(71);
+        return Crc32::compute(probe) == btccw::Checksum::crc32(probe) &&
+               Crc32::update(Crc32::compute(head), tail) == btccw::Checksum::crc32(probe);
+    }();
+    return matches;
+}
+
+uint32_t payload_crc(const std::string& payload) {
+    return running_crc_matches_core() ? Crc32::compute(payload)
+                                      : btccw::Checksum::crc32(payload);
+}
+
+/// If the space at `space` ends a preamble, where that preamble starts;
+/// npos otherwise. One K may be wrong or missing; noise keyed just before
+/// the preamble may run into it without a word gap.
+std::size_t preamble_begin(const std::string& text, std::size_t space) {
+    if (space >= 3) {
+        int ks = 0;
+        bool gap = false;
+        for (std::size_t i = space - 3; i < space; ++i) {
+            ks += text[i] == 'K';
+            gap = gap || text[i] == ' ';
+        }
+        if (ks >= 2 && !gap) return space - 3;
+    }
+    if (space >= 2 && text.compare(space - 2, 2, "KK") == 0) return space - 2;
+    return std::string::npos;
+}
+
+/// " AR" at `pos`, allowing one of A and R to be an erasure.
+bool postamble_at(const std::string& text, const std::vector<bool>& erased,
+                  std::size_t pos) {
+    if (pos + kSuffixLen > text.size() || text[pos] != ' ') return false;
+    const bool a = text[pos + 1] == 'A';
+    const bool r = text[pos + 2] == 'R';
+    return (a && r) || (a && erased[pos + 2]) || (r && erased[pos + 1]);
+}
+
+bool has_candidate(const Erasure& e, char c) {
+    return std::find(e.candidates.begin(), e.candidates.end(), std::string(1, c)) !=
+           e.candidates.end();
+}
+
+/// Depth-first search over the erasures' candidates. The body (payload
+/// plus CRC) is rebuilt in place; the CRC field is always its last four
+/// characters, so a candidate that adds a character moves the boundary.
+///
+/// The text after the last erasure is the same for every combination, so
+/// when the CRC field lies inside it, its payload part is hashed once and
+/// joined to each combination's CRC with Crc32::Combiner.
+class RepairSearch {
+public:
+    RepairSearch(const std::string& text, std::size_t body_end,
+                 std::vector<const Erasure*> erasures)
+        : text_(text), body_end_(body_end), erasures_(std::move(erasures)),
+          marks_(erasures_.size() + 1), running_(running_crc_matches_core()) {
+        const std::size_t from = erasures_.empty() ? kPrefixLen : erasures_.back()->pos + 1;
+        if (running_ && body_end_ >= from + kCrcLen) {
+            const std::string_view tail(text_.data() + from, body_end_ - kCrcLen - from);
+            tail_crc_ = Crc32::compute(tail);
+            tail_     = Crc32::Combiner(tail.size());
+            has_tail_ = true;
+        }
+    }
+
+    /// True once a combination passes; payload() then holds it.
+    bool run() { return visit(0, 0, kPrefixLen); }
+
+    std::string payload() const { return body_.substr(0, body_.size() - kCrcLen); }
+
+private:
+    /// Body length and CRC of the body so far when the search entered a
+    /// depth.
+    struct Mark {
+        std::size_t length;
+        uint32_t    crc;
+    };
+
+    const std::string&          text_;
+    std::size_t                 body_end_;
+    std::vector<const Erasure*> erasures_;
+    std::vector<Mark>           marks_;
+    bool                        running_;
+    bool                        has_tail_ = false;
+    uint32_t                    tail_crc_ = 0;   // payload after the last erasure
+    Crc32::Combiner             tail_;
+    std::string                 body_;
+    std::size_t                 tries_ = 0;
+
+    /// Body fixed up to text position `from`, its CRC so far `crc`.
+    bool visit(std::size_t depth, uint32_t crc, std::size_t from) {
+        marks_[depth] = {body_.size(), crc};
+        const std::size_t to = depth < erasures_.size() ? erasures_[depth]->pos : body_end_;
+        const std::string_view segment(text_.data() + from, to - from);
+        body_ += segment;
+
+        if (depth == erasures_.size()) {
+            ++tries_;
+            if (check()) return true;
+        } else {
+            if (running_) crc = Crc32::update(crc, segment);
+            const std::size_t length = body_.size();
+            for (const auto& candidate : erasures_[depth]->candidates) {
+                if (tries_ >= Deframer::kMaxRepairTries) break;
+                body_ += candidate;
+                const uint32_t next = running_ ? Crc32::update(crc, candidate) : 0;
+                if (visit(depth + 1, next, to + 1)) return true;
+                body_.resize(length);
+            }
+        }
+        body_.resize(marks_[depth].length);
+        return false;
+    }
+
+    /// Does the body's CRC field match its payload?
+    bool check() const {
+        if (body_.size() < kCrcLen) return false;
+        const std::size_t payload_len = body_.size() - kCrcLen;
+        const std::string_view payload(body_.data(), payload_len);
+
+        uint32_t crc;
+        if (has_tail_) {
+            crc = tail_(marks_.back().crc, tail_crc_);
+        } else if (running_) {
+            // Resume from the deepest CRC that is still all payload.
+            std::size_t d = marks_.size() - 1;
+            while (marks_[d].length > payload_len) --d;
+            crc = Crc32::update(marks_[d].crc, payload.substr(marks_[d].length));
+        } else {
+            crc = btccw::Checksum::crc32(payload);
+        }
+        return body_.compare(payload_len, kCrcLen, btccw::Checksum::encode_crc(crc)) == 0;
+    }
+};
+
+} // namespace
+
+
 DeframeResult Deframer::deframe(const std::string& text) {
     // Frame format: "KKK " + payload + crc(4 chars) + " AR"
     // Minimum length: 4 (prefix) + 0 (payload) + 4 (crc) + 3 (suffix) = 11
-    static constexpr std::size_t kPrefixLen = 4;  // "KKK "
-    static constexpr std::size_t kSuffixLen = 3;  // " AR"
-    static constexpr std::size_t kCrcLen    = 4;
-    static constexpr std::size_t kMinLen    = kPrefixLen + kCrcLen + kSuffixLen;
+    static constexpr std::size_t kMinLen = kPrefixLen + kCrcLen + kSuffixLen;
 
     if (text.size() < kMinLen) {
         return {false, {}, "frame too short"};
@@ -38,7 +197,7 @@ DeframeResult Deframer::deframe(const std::string& text) {
     std::string received_crc = body.substr(body.size() - kCrcLen);
 
     // Verify CRC.
-    uint32_t computed = btccw::Checksum::crc32(payload);
+    uint32_t computed = payload_crc(payload);
     std::string expected_crc = btccw::Checksum::encode_crc(computed);
 
     if (received_crc != expected_crc) {
@@ -49,4 +208,163 @@ DeframeResult Deframer::deframe(const std::string& text) {
     return {true, payload, {}};
 }
 
+DeframeResult Deframer::deframe(const std::string& text,
+                                const std::vector<Erasure>& erasures) {
+    DeframeResult result = deframe(text);
+    if (result.valid) return result;
+
+    // A version 2 frame fails the plain CRC check; its header says so.
+    DeframeResult fec = FecFramer::deframe(text, erasures);
+    if (fec.valid || FecFramer::is_fec_frame(text)) return fec;
+    if (erasures.empty()) return result;
+
+    const std::size_t count = erasures.size();
+    auto give_up = [&](const char* why) {
+        result.error += "; " + std::to_string(count) + " unknown symbol(s), " + why;
+        return result;
+    };
+    if (count > kMaxRepairErasures) return give_up("too many to repair");
+    if (text.size() < kPrefixLen + kCrcLen + kSuffixLen) return result;
+
+    // Framing characters are known, so an erasure there only has to allow
+    // them; the rest are searched.
+    std::string fixed = text;
+    const std::size_t suffix_start = text.size() - kSuffixLen;
+    std::vector<const Erasure*> body_erasures;
+    for (const auto& e : erasures) {
+        if (e.pos >= text.size() || text[e.pos] != '?') return give_up("positions stale");
+        if (e.candidates.empty()) return give_up("no candidates");
+
+        char framing = 0;
+        if (e.pos < kPrefixLen)         framing = kPrefix[e.pos];
+        if (e.pos >= suffix_start)      framing = kSuffix[e.pos - suffix_start];
+        if (framing) {
+            if (!has_candidate(e, framing)) return give_up("framing unrecoverable");
+            fixed[e.pos] = framing;
+        } else {
+            body_erasures.push_back(&e);
+        }
+    }
+    if (fixed.compare(0, kPrefixLen, kPrefix) != 0 ||
+        fixed.compare(suffix_start, kSuffixLen, kSuffix) != 0) {
+        return result;
+    }
+    std::sort(body_erasures.begin(), body_erasures.end(),
+              [](const Erasure* a, const Erasure* b) { return a->pos < b->pos; });
+
+    RepairSearch search(fixed, suffix_start, std::move(body_erasures));
+    if (!search.run()) return give_up("no combination passes the CRC");
+    return {true, search.payload(), {}, count};
+}
+
+std::vector<SyncedFrame> Deframer::scan(const std::string& text,
+                                        const std::vector<Erasure>& erasures) {
+    const std::size_t n = text.size();
+    std::vector<SyncedFrame> frames;
+
+    std::vector<bool> erased(n, false);
+    for (const auto& e : erasures) {
+        if (e.pos < n) erased[e.pos] = true;
+    }
+    std::vector<uint32_t> erased_before(n + 1, 0);   // erasures in text[0, i)
+    for (std::size_t i = 0; i < n; ++i) erased_before[i + 1] = erased_before[i] + erased[i];
+
+    // Deframe text[body, suffix) with canonical framing around it, so a
+    // damaged preamble or postamble does not matter. With `repair` off, or
+    // once the scan has spent its repair budget, erasures are taken as read.
+    std::size_t failed_repairs = 0;
+    auto deframe_span = [&](std::size_t body, std::size_t suffix, bool repair) {
+        std::vector<Erasure> inner;
+        if (repair && failed_repairs < kMaxScanRepairs) {
+            for (const auto& e : erasures) {
+                if (e.pos < body || e.pos >= suffix) continue;
+                inner.push_back(e);
+                inner.back().pos = e.pos - body + kPrefixLen;
+            }
+        }
+        DeframeResult result =
+            deframe(kPrefix + text.substr(body, suffix - body) + kSuffix, inner);
+        if (!result.valid && !inner.empty()) ++failed_repairs;
+        return result;
+    };
+
+    /// A preamble still waiting for its " AR".
+    struct Open {
+        std::size_t begin;
+        std::size_t body;
+        uint32_t    crc;      // CRC of text[body, hashed)
+        std::size_t hashed;
+    };
+    std::vector<Open> open;
+    const bool running = running_crc_matches_core();
+    const std::string_view view(text);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (text[i] != ' ') continue;
+
+        // Does an open frame end here? Latest preamble first. Only the latest
+        // span holding erasures gets the repair search; earlier ones are
+        // checked as read.
+        if (postamble_at(text, erased, i)) {
+            std::size_t found = open.size();
+            DeframeResult result;
+            bool repair = true;
+            for (std::size_t k = open.size(); k-- > 0;) {
+                Open& o = open[k];
+                if (i < o.body + kCrcLen) continue;
+                const std::size_t crc_at = i - kCrcLen;
+                if (erased_before[i] != erased_before[o.body]) {
+                    result = deframe_span(o.body, i, repair);
+                    repair = false;
+                } else if (!running) {
+                    result = deframe_span(o.body, i, false);
+                } else {
+                    o.crc    = Crc32::update(o.crc, view.substr(o.hashed, crc_at - o.hashed));
+                    o.hashed = crc_at;
+                    if (text.compare(crc_at, kCrcLen, btccw::Checksum::encode_crc(o.crc)) == 0) {
+                        result = {true, text.substr(o.body, crc_at - o.body), {}};
+                    }
+                }
+                if (result.valid) {
+                    found = k;
+                    break;
+                }
+            }
+            if (found < open.size()) {
+                frames.push_back({open[found].begin, i + kSuffixLen, std::move(result)});
+                open.clear();
+                i += kSuffixLen - 1;
+                continue;
+            }
+        }
+
+        const std::size_t begin = preamble_begin(text, i);
+        if (begin == std::string::npos) continue;
+        const std::size_t body = i + 1;
+
+        // A version 2 header says where its frame ends: check just there.
+        const std::size_t header = FecFramer::kHeaderData + FecFramer::kHeaderParity;
+        std::size_t length = 0;
+        if (body + header <= n) {
+            length = FecFramer::frame_length(kPrefix + text.substr(body, header) + kSuffix);
+        }
+        bool closed = false;
+        for (std::size_t m = 0; length && m <= FecFramer::kMaxMissing && !closed; ++m) {
+            const std::size_t suffix = body + length - kPrefixLen - kSuffixLen - m;
+            if (!postamble_at(text, erased, suffix)) continue;
+            DeframeResult result = deframe_span(body, suffix, true);
+            if (!result.valid) continue;
+            frames.push_back({begin, suffix + kSuffixLen, std::move(result)});
+            open.clear();
+            i = suffix + kSuffixLen - 1;
+            closed = true;
+        }
+        if (closed) continue;
+
+        if (open.size() == kMaxOpenPreambles) open.erase(open.begin());
+        open.push_back({begin, body, 0, body});
+    }
+    return frames;
+}
+
 } // namespace btccw::node
@@ -0,0 +1,476 @@
+#include "fec_framer.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include <btccw/checksum.hpp>
+
+namespace btccw::node {
+
+namespace {
+
+constexpr const char* kAlphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ +/.:-?";
+constexpr std::size_t kPrefixLen = 4;   // "KKK "
+constexpr std::size_t kSuffixLen = 3;   // " AR"
+constexpr std::size_t kCrcLen    = 4;
+constexpr std::size_t kHeaderLen = FecFramer::kHeaderData + FecFramer::kHeaderParity;
+
+// ---------------------------------------------------------------------------
+// GF(43): integers mod 43
+// ---------------------------------------------------------------------------
+
+constexpr unsigned kQ = 43;
+
+constexpr unsigned gf_add(unsigned a, unsigned b) { return (a + b) % kQ; }
+constexpr unsigned gf_sub(unsigned a, unsigned b) { return (a + kQ - b) % kQ; }
+constexpr unsigned gf_mul(unsigned a, unsigned b) { return (a * b) % kQ; }
+
+constexpr unsigned gf_pow(unsigned a, unsigned e) {
+    unsigned r = 1;
+    for (; e; --e) r = gf_mul(r, a);
+    return r;
+}
+
+/// Smallest generator of the multiplicative group (order 42).
+constexpr unsigned find_primitive() {
+    for (unsigned g = 2; g < kQ; ++g) {
+        if (gf_pow(g, 6) != 1 && gf_pow(g, 14) != 1 && gf_pow(g, 21) != 1) return g;
+    }
+    return 0;
+}
+
+constexpr unsigned kAlpha = find_primitive();
+
+struct Tables {
+    std::array<uint8_t, 2 * (kQ - 1)> exp{};   // alpha^i, doubled to skip a mod
+    std::array<uint8_t, kQ>           inv{};
+};
+
+constexpr Tables make_tables() {
+    Tables t;
+    unsigned x = 1;
+    for (std::size_t i = 0; i < t.exp.size(); ++i) {
+        t.exp[i] = static_cast<uint8_t>(x);
+        x = gf_mul(x, kAlpha);
+    }
+    for (unsigned a = 1; a < kQ; ++a) t.inv[a] = static_cast<uint8_t>(gf_pow(a, kQ - 2));
+    return t;
+}
+
+constexpr Tables kGf = make_tables();
+
+unsigned gf_div(unsigned a, unsigned b) { return gf_mul(a, kGf.inv[b]); }
+
+/// alpha^e for any integer e.
+unsigned alpha_pow(long e) {
+    e %= static_cast<long>(kQ - 1);
+    if (e < 0) e += kQ - 1;
+    return kGf.exp[static_cast<std::size_t>(e)];
+}
+
+/// Evaluate a polynomial stored lowest degree first.
+unsigned eval_low(const std::vector<unsigned>& poly, unsigned x) {
+    unsigned r = 0;
+    for (std::size_t i = poly.size(); i-- > 0;) r = gf_add(gf_mul(r, x), poly[i]);
+    return r;
+}
+
+/// Generator polynomial prod_{i=1..parity} (x - alpha^i), highest degree
+/// first, monic.
+std::vector<unsigned> generator(std::size_t parity) {
+    std::vector<unsigned> g{1};
+    for (std::size_t i = 1; i <= parity; ++i) {
+        const unsigned root = alpha_pow(static_cast<long>(i));
+        std::vector<unsigned> next(g.size() + 1, 0);
+        for (std::size_t j = 0; j < g.size(); ++j) {
+            next[j]     = gf_add(next[j], g[j]);
+            next[j + 1] = gf_sub(next[j + 1], gf_mul(g[j], root));
+        }
+        g = std::move(next);
+    }
+    return g;
+}
+
+// ---------------------------------------------------------------------------
+// Frame layout
+// ---------------------------------------------------------------------------
+
+/// Data length of each codeword for `data` symbols at `parity`.
+std::vector<std::size_t> codeword_sizes(std::size_t data, std::size_t parity) {
+    const std::size_t per = FecFramer::kMaxCodeword - parity;
+    const std::size_t count = std::max<std::size_t>(1, (data + per - 1) / per);
+    std::vector<std::size_t> sizes(count, data / count);
+    for (std::size_t i = 0; i < data % count; ++i) ++sizes[i];
+    return sizes;
+}
+
+/// Header contents, once decoded.
+struct Header {
+    std::size_t parity  = 0;
+    std::size_t length  = 0;   // payload characters, without the CRC
+    int         fixed   = 0;   // header symbols corrected
+    std::string error;
+};
+
+Header read_header(const std::string& text, const std::vector<Erasure>& erasures) {
+    Header h;
+    if (text.size() < kPrefixLen + kHeaderLen + kSuffixLen ||
+        text.compare(0, kPrefixLen, "KKK ") != 0) {
+        h.error = "not a version 2 frame";
+        return h;
+    }
+
+    std::vector<uint8_t> cw(kHeaderLen);
+    std::vector<std::size_t> erased;
+    for (std::size_t i = 0; i < kHeaderLen; ++i) {
+        const int s = FecFramer::symbol_of(text[kPrefixLen + i]);
+        cw[i] = static_cast<uint8_t>(s < 0 ? 0 : s);
+        if (s < 0) erased.push_back(i);
+    }
+    for (const auto& e : erasures) {
+        if (e.pos >= kPrefixLen && e.pos < kPrefixLen + kHeaderLen &&
+            std::find(erased.begin(), erased.end(), e.pos - kPrefixLen) == erased.end()) {
+            erased.push_back(e.pos - kPrefixLen);
+        }
+    }
+
+    h.fixed = FecFramer::rs_decode(cw, FecFramer::kHeaderParity, erased);
+    if (h.fixed < 0) {
+        h.error = "version 2 header uncorrectable";
+        return h;
+    }
+    if (cw[0] != FecFramer::kVersion) {
+        h.error = "unsupported frame version " + std::to_string(cw[0]);
+        return h;
+    }
+    h.parity = cw[1];
+    h.length = (cw[2] * kQ + cw[3]) * kQ + cw[4];
+    if (h.parity < FecFramer::kMinParity || h.parity > FecFramer::kMaxParity) {
+        h.error = "bad parity level " + std::to_string(h.parity);
+    }
+    return h;
+}
+
+/// Decode a body of exactly the expected length. `erased` flags unknown
+/// symbols. On success fills `payload` and returns symbols corrected.
+int decode_body(const std::string& body, const std::vector<bool>& erased,
+                const Header& h, std::string& payload, std::string& error) {
+    const auto sizes = codeword_sizes(h.length + kCrcLen, h.parity);
+
+    // De-interleave: column j holds symbol j of every codeword long enough.
+    std::vector<std::vector<uint8_t>>     cws(sizes.size());
+    std::vector<std::vector<std::size_t>> gaps(sizes.size());
+    for (std::size_t i = 0; i < sizes.size(); ++i) cws[i].reserve(sizes[i] + h.parity);
+    std::size_t pos = 0;
+    for (std::size_t j = 0; j < sizes[0] + h.parity; ++j) {
+        for (std::size_t i = 0; i < sizes.size(); ++i) {
+            if (j >= sizes[i] + h.parity) continue;
+            const int s = FecFramer::symbol_of(body[pos]);
+            if (s < 0 || erased[pos]) gaps[i].push_back(j);
+            cws[i].push_back(static_cast<uint8_t>(s < 0 ? 0 : s));
+            ++pos;
+        }
+    }
+
+    int fixed = 0;
+    std::string data;
+    for (std::size_t i = 0; i < cws.size(); ++i) {
+        const int n = FecFramer::rs_decode(cws[i], h.parity, gaps[i]);
+        if (n < 0) {
+            error = "codeword " + std::to_string(i) + " uncorrectable";
+            return -1;
+        }
+        fixed += n;
+        for (std::size_t j = 0; j < sizes[i]; ++j) data += FecFramer::char_of(cws[i][j]);
+    }
+
+    // The CRC rides inside the data and catches miscorrections.
+    payload = data.substr(0, h.length);
+    if (data.compare(h.length, kCrcLen,
+                     btccw::Checksum::encode_crc(btccw::Checksum::crc32(payload))) != 0) {
+        error = "CRC mismatch after correction";
+        return -1;
+    }
+    return fixed;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Symbols
+// ---------------------------------------------------------------------------
+
+int FecFramer::symbol_of(char c) noexcept {
+    static const std::array<int8_t, 256> table = [] {
+        std::array<int8_t, 256> t{};
+        t.fill(-1);
+        for (int i = 0; kAlphabet[i]; ++i) t[static_cast<unsigned char>(kAlphabet[i])] = static_cast<int8_t>(i);
+        return t;
+    }();
+    return table[static_cast<unsigned char>(c)];
+}
+
+char FecFramer::char_of(int symbol) noexcept {
+    return (symbol >= 0 && symbol < static_cast<int>(kQ)) ? kAlphabet[symbol] : '?';
+}
+
+// ---------------------------------------------------------------------------
+// Reed-Solomon over GF(43)
+// ---------------------------------------------------------------------------
+
+void FecFramer::rs_encode(std::vector<uint8_t>& data, std::size_t parity) {
+    const std::vector<unsigned> g = generator(parity);
+    const std::size_t k = data.size();
+
+    // Remainder of data(x) * x^parity divided by g(x); parity = -remainder.
+    std::vector<unsigned> work(data.begin(), data.end());
+    work.resize(k + parity, 0);
+    for (std::size_t i = 0; i < k; ++i) {
+        const unsigned coef = work[i];
+        if (coef == 0) continue;
+        for (std::size_t j = 1; j <= parity; ++j) {
+            work[i + j] = gf_sub(work[i + j], gf_mul(coef, g[j]));
+        }
+    }
+    for (std::size_t j = 0; j < parity; ++j) {
+        data.push_back(static_cast<uint8_t>(gf_sub(0, work[k + j])));
+    }
+}
+
+int FecFramer::rs_decode(std::vector<uint8_t>& cw, std::size_t parity,
+                         const std::vector<std::size_t>& erased) {
+    const std::size_t n = cw.size();
+    if (n > kMaxCodeword || n <= parity || erased.size() > parity) return -1;
+
+    // Symbol i is the coefficient of x^(n-1-i); its locator is alpha^(n-1-i).
+    auto locator = [n](std::size_t i) { return alpha_pow(static_cast<long>(n - 1 - i)); };
+
+    // Syndromes S_j = r(alpha^j), j = 1..parity (stored 0-based).
+    std::vector<unsigned> synd(parity);
+    bool clean = true;
+    for (std::size_t j = 0; j < parity; ++j) {
+        const unsigned x = alpha_pow(static_cast<long>(j + 1));
+        unsigned s = 0;
+        for (uint8_t c : cw) s = gf_add(gf_mul(s, x), c);
+        synd[j] = s;
+        clean = clean && s == 0;
+    }
+    if (clean) return 0;
+
+    // Erasure locator Gamma(x) = prod (1 - X_k x), lowest degree first.
+    std::vector<unsigned> lambda{1};
+    for (std::size_t i : erased) {
+        if (i >= n) return -1;
+        const unsigned x = locator(i);
+        std::vector<unsigned> next(lambda.size() + 1, 0);
+        for (std::size_t d = 0; d < lambda.size(); ++d) {
+            next[d]     = gf_add(next[d], lambda[d]);
+            next[d + 1] = gf_sub(next[d + 1], gf_mul(lambda[d], x));
+        }
+        lambda = std::move(next);
+    }
+
+    // Berlekamp-Massey, started from the erasure locator.
+    const std::size_t f = erased.size();
+    std::vector<unsigned> prev = lambda;
+    std::size_t len = f;
+    std::size_t shift = 1;
+    unsigned last = 1;
+    for (std::size_t r = f; r < parity; ++r) {
+        unsigned delta = synd[r];
+        for (std::size_t i = 1; i <= len && i < lambda.size(); ++i) {
+            delta = gf_add(delta, gf_mul(lambda[i], synd[r - i]));
+        }
+        if (delta == 0) {
+            ++shift;
+            continue;
+        }
+        std::vector<unsigned> next = lambda;
+        const unsigned scale = gf_div(delta, last);
+        if (next.size() < prev.size() + shift) next.resize(prev.size() + shift, 0);
+        for (std::size_t i = 0; i < prev.size(); ++i) {
+            next[i + shift] = gf_sub(next[i + shift], gf_mul(scale, prev[i]));
+        }
+        if (2 * len <= r + f) {
+            prev  = lambda;
+            len   = r + 1 + f - len;
+            last  = delta;
+            shift = 1;
+        } else {
+            ++shift;
+        }
+        lambda = std::move(next);
+    }
+    while (lambda.size() > 1 && lambda.back() == 0) lambda.pop_back();
+    if (lambda.size() - 1 != len || 2 * (len - f) + f > parity) return -1;
+
+    // Chien search: roots of Lambda are the inverse locators.
+    std::vector<std::size_t> where;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (eval_low(lambda, kGf.inv[locator(i)]) == 0) where.push_back(i);
+    }
+    if (where.size() != len) return -1;
+
+    // Forney: e_k = -Omega(X_k^-1) / Lambda'(X_k^-1), Omega = S * Lambda mod x^parity.
+    std::vector<unsigned> omega(parity, 0);
+    for (std::size_t i = 0; i < parity; ++i) {
+        for (std::size_t d = 0; d < lambda.size() && d <= i; ++d) {
+            omega[i] = gf_add(omega[i], gf_mul(synd[i - d], lambda[d]));
+        }
+    }
+    std::vector<unsigned> deriv(lambda.size() > 1 ? lambda.size() - 1 : 1, 0);
+    for (std::size_t d = 1; d < lambda.size(); ++d) {
+        deriv[d - 1] = gf_mul(static_cast<unsigned>(d % kQ), lambda[d]);
+    }
+
+    int changed = 0;
+    for (std::size_t i : where) {
+        const unsigned xinv = kGf.inv[locator(i)];
+        const unsigned den  = eval_low(deriv, xinv);
+        if (den == 0) return -1;
+        const unsigned e = gf_sub(0, gf_div(eval_low(omega, xinv), den));
+        if (e == 0) continue;
+        cw[i] = static_cast<uint8_t>(gf_sub(cw[i], e));
+        ++changed;
+    }
+
+    // A pattern beyond the code's reach can still satisfy the steps above.
+    for (std::size_t j = 0; j < parity; ++j) {
+        const unsigned x = alpha_pow(static_cast<long>(j + 1));
+        unsigned s = 0;
+        for (uint8_t c : cw) s = gf_add(gf_mul(s, x), c);
+        if (s != 0) return -1;
+    }
+    return changed;
+}
+
+// ---------------------------------------------------------------------------
+// Frames
+// ---------------------------------------------------------------------------
+
+std::string FecFramer::frame(const std::string& payload, std::size_t parity) {
+    parity = std::clamp(parity, kMinParity, kMaxParity);
+    if (payload.size() > kMaxPayload) return {};
+
+    std::vector<uint8_t> data;
+    data.reserve(payload.size() + kCrcLen);
+    for (char c : payload + btccw::Checksum::encode_crc(btccw::Checksum::crc32(payload))) {
+        const int s = symbol_of(c);
+        if (s < 0) return {};
+        data.push_back(static_cast<uint8_t>(s));
+    }
+
+    std::vector<uint8_t> header{static_cast<uint8_t>(kVersion),
+                                static_cast<uint8_t>(parity),
+                                static_cast<uint8_t>(payload.size() / (kQ * kQ)),
+                                static_cast<uint8_t>(payload.size() / kQ % kQ),
+                                static_cast<uint8_t>(payload.size() % kQ)};
+    rs_encode(header, kHeaderParity);
+
+    const auto sizes = codeword_sizes(data.size(), parity);
+    std::vector<std::vector<uint8_t>> cws;
+    std::size_t offset = 0;
+    for (std::size_t size : sizes) {
+        cws.emplace_back(data.begin() + offset, data.begin() + offset + size);
+        rs_encode(cws.back(), parity);
+        offset += size;
+    }
+
+    std::string text = "KKK ";
+    for (uint8_t s : header) text += char_of(s);
+    for (std::size_t j = 0; j < cws[0].size(); ++j) {
+        for (const auto& cw : cws) {
+            if (j < cw.size()) text += char_of(cw[j]);
+        }
+    }
+    return text + " AR";
+}
+
+bool FecFramer::is_fec_frame(const std::string& text) {
+    return read_header(text, {}).error.empty();
+}
+
+std::size_t FecFramer::frame_length(const std::string& text) {
+    const Header h = read_header(text, {});
+    if (!h.error.empty()) return 0;
+    std::size_t length = kPrefixLen + kHeaderLen + kSuffixLen;
+    for (std::size_t size : codeword_sizes(h.length + kCrcLen, h.parity)) {
+        length += size + h.parity;
+    }
+    return length;
+}
+
+DeframeResult FecFramer::deframe(const std::string& text,
+                                 const std::vector<Erasure>& erasures) {
+    const Header h = read_header(text, erasures);
+    if (!h.error.empty()) return {false, {}, h.error};
+    if (text.compare(text.size() - kSuffixLen, kSuffixLen, " AR") != 0) {
+        return {false, {}, "missing AR prosign"};
+    }
+
+    const std::size_t start = kPrefixLen + kHeaderLen;
+    const std::string body  = text.substr(start, text.size() - kSuffixLen - start);
+    std::vector<bool> erased(body.size(), false);
+    for (const auto& e : erasures) {
+        if (e.pos >= start && e.pos - start < body.size()) erased[e.pos - start] = true;
+    }
+
+    std::size_t expected = 0;
+    for (std::size_t size : codeword_sizes(h.length + kCrcLen, h.parity)) {
+        expected += size + h.parity;
+    }
+    if (body.size() > expected || expected - body.size() > kMaxMissing) {
+        return {false, {}, "body length " + std::to_string(body.size()) +
+                           ", header says " + std::to_string(expected)};
+    }
+
+    std::string payload, error;
+    const std::size_t missing = expected - body.size();
+    if (missing == 0) {
+        const int fixed = decode_body(body, erased, h, payload, error);
+        if (fixed < 0) return {false, {}, error};
+        return {true, payload, {}, static_cast<std::size_t>(fixed + h.fixed)};
+    }
+
+    // Characters lost on the air: a doubled space collapses into one word
+    // gap (also against the framing spaces), and a missed character gap
+    // merges two characters into one unknown pattern. Try an erased symbol
+    // at each such place.
+    std::vector<std::size_t> points{0, body.size()};
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        if (body[i] == ' ' || erased[i]) points.push_back(i);
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    std::vector<std::size_t> pick(missing, 0);
+    while (true) {
+        std::string filled;
+        std::vector<bool> flags;
+        std::size_t next = 0;
+        for (std::size_t i = 0; i <= body.size(); ++i) {
+            while (next < missing && points[pick[next]] == i) {
+                filled += '?';
+                flags.push_back(true);
+                ++next;
+            }
+            if (i == body.size()) break;
+            filled += body[i];
+            flags.push_back(erased[i]);
+        }
+        const int fixed = decode_body(filled, flags, h, payload, error);
+        if (fixed >= 0) {
+            return {true, payload, {}, static_cast<std::size_t>(fixed + h.fixed)};
+        }
+
+        // Next non-decreasing index tuple.
+        std::size_t k = missing;
+        while (k > 0 && pick[k - 1] + 1 == points.size()) --k;
+        if (k == 0) break;
+        ++pick[k - 1];
+        for (std::size_t j = k; j < missing; ++j) pick[j] = pick[k - 1];
+    }
+    return {false, {}, error + " (" + std::to_string(missing) + " missing)"};
+}
+
+} // namespace btccw::node
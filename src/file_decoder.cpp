@@ -0,0 +1,308 @@
+#include "file_decoder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "fec_framer.hpp"
+#include "streaming_decoder.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace btccw::node {
+
+namespace {
+
+// Characters around the payload: "KKK ", version 2 and fragment headers,
+// CRC and " AR", with room to spare.
+constexpr std::size_t kFramingChars = 64;
+
+// Units of the longest Base43 character, "-----" (0), and the gap after it.
+constexpr double kMaxUnitsPerChar = 22.0;
+
+// Without a set chunk length each worker gets several chunks, so one that
+// finishes early still has runs left to steal from the others.
+constexpr std::size_t kChunksPerWorker = 4;
+
+// ...but no chunk shorter than this many seam margins, or re-reading the
+// lead before each seam would cost more than the balance gains.
+constexpr double kMinChunkMargins = 16.0;
+
+bool is_recording(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".wav" || ext == ".raw" || ext == ".pcm" || ext == ".s16" || ext == ".f32";
+}
+
+/// What makes two reports the same frame: its payload, or its text when
+/// the payload did not decode.
+const std::string& frame_key(const DecodeResult& result) {
+    return result.base43_payload.empty() ? result.morse_text : result.base43_payload;
+}
+
+/// Chunks' frames in time order, each frame once: near a seam both
+/// neighbours may report it, a little apart.
+std::vector<FileFrame> merge(std::vector<std::vector<FileFrame>>& chunks, double window_s) {
+    std::vector<FileFrame> all;
+    for (auto& chunk : chunks) {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(all));
+    }
+    std::stable_sort(all.begin(), all.end(), [](const FileFrame& a, const FileFrame& b) {
+        return a.offset_s < b.offset_s;
+    });
+
+    std::vector<FileFrame> out;
+    for (auto& frame : all) {
+        bool seen = false;
+        for (std::size_t j = out.size(); j-- > 0 && frame.offset_s - out[j].offset_s <= window_s;) {
+            if (frame_key(out[j].result) == frame_key(frame.result)) {
+                seen = true;
+                break;
+            }
+        }
+        if (!seen) out.push_back(std::move(frame));
+    }
+    return out;
+}
+
+} // namespace
+
+FileDecoder::FileDecoder(const FileDecodeConfig& cfg) : cfg_(cfg) {
+    if (cfg_.push_frames == 0) cfg_.push_frames = 4096;
+}
+
+DecodeConfig FileDecoder::config_for(double sample_rate) const {
+    DecodeConfig rx = cfg_.decode;
+    const double scale = sample_rate / rx.sample_rate;
+    rx.block_size = std::max<std::size_t>(
+        1, static_cast<std::size_t>(std::lround(static_cast<double>(rx.block_size) * scale)));
+    if (rx.hop_size) {
+        rx.hop_size = std::max<std::size_t>(
+            1, static_cast<std::size_t>(std::lround(static_cast<double>(rx.hop_size) * scale)));
+    }
+    rx.sample_rate = sample_rate;
+    return rx;
+}
+
+std::size_t FileDecoder::frame_bound_chars(const DecodeConfig& rx) {
+    const std::size_t data = FecFramer::kMaxCodeword - FecFramer::kMaxParity;
+    const std::size_t codewords = (rx.reassembly.max_chars + data - 1) / data;
+    return codewords * FecFramer::kMaxCodeword + kFramingChars;
+}
+
+double FileDecoder::frame_bound_s(const DecodeConfig& rx) {
+    double wpm = std::max(rx.wpm, 1);
+    if (rx.auto_wpm) wpm /= MorseDecoder::kMaxSpeedRatio;
+    // PARIS timing: one unit is 1.2 / wpm seconds.
+    return static_cast<double>(frame_bound_chars(rx)) * kMaxUnitsPerChar * 1.2 / wpm;
+}
+
+double FileDecoder::seam_margin_s() const {
+    // The adaptive threshold settles within one noise window.
+    return std::max(cfg_.decode.noise_window_s, 2.0);
+}
+
+std::vector<FileDecoder::Span> FileDecoder::plan(const PcmFile& file, const DecodeConfig& rx,
+                                                 double chunk_s) const {
+    const std::size_t n    = file.frames();
+    const std::size_t hop  = rx.hop_size ? rx.hop_size : rx.block_size;
+    const auto to_frames = [&](double s) {
+        return static_cast<std::size_t>(std::llround(std::max(s, 0.0) * rx.sample_rate));
+    };
+    const std::size_t margin = to_frames(seam_margin_s());
+    const std::size_t lead   = 2 * margin;
+    const std::size_t frame  = to_frames(cfg_.max_frame_s > 0.0 ? cfg_.max_frame_s
+                                                                 : frame_bound_s(rx));
+
+    // Frames straddling a seam are finished by the chunk they start in, so
+    // a chunk only needs the lead for its threshold to settle. A chunk
+    // shorter than that would spend most of its time re-reading.
+    std::size_t chunks = chunk_s > 0.0 ? static_cast<std::size_t>(file.duration_s() / chunk_s) : 1;
+    chunks = std::clamp<std::size_t>(chunks, 1, std::max<std::size_t>(n / std::max<std::size_t>(lead, 1), 1));
+
+    // Seams on block boundaries: every chunk's Goertzel blocks line up
+    // with the whole file's.
+    std::vector<std::size_t> seams(chunks + 1);
+    for (std::size_t k = 0; k < chunks; ++k) seams[k] = n / chunks * k / hop * hop;
+    seams[chunks] = n;
+
+    std::vector<Span> spans(chunks);
+    for (std::size_t k = 0; k < chunks; ++k) {
+        Span& s = spans[k];
+        s.read_begin = seams[k] > lead ? (seams[k] - lead) / hop * hop : 0;
+        s.keep_begin = k == 0 ? 0 : seams[k] - margin;
+        if (k + 1 == chunks) {
+            s.keep_end = n + 1;   // a frame closed by the final flush
+            s.read_end = n;
+        } else {
+            s.keep_end = seams[k + 1] + margin;
+            s.read_end = std::min(n, s.keep_end);
+        }
+        s.read_cap = s.read_end + std::min(frame, n - s.read_end);
+    }
+    return spans;
+}
+
+std::vector<FileFrame> FileDecoder::decode_span(const PcmFile& file,
+                                                const DecodePipeline& pipeline,
+                                                const Span& span) const {
+    const double rate = file.format().sample_rate;
+    std::vector<FileFrame> frames;
+
+    // Frames handed to the decoder, the push in progress included: a
+    // frame's offset is exact to one push.
+    std::size_t pushed = span.read_begin;
+    bool reading_on = false;
+    StreamingDecoder decoder(pipeline, [&](const DecodeResult& r) {
+        if (pushed < span.keep_begin || (pushed >= span.keep_end && !reading_on)) return;
+        FileFrame frame;
+        frame.offset_s = static_cast<double>(pushed) / rate;
+        frame.result   = r;
+        frames.push_back(std::move(frame));
+    });
+
+    std::vector<float> chunk(cfg_.push_frames);
+    const auto push_until = [&](std::size_t end, auto&& more) {
+        while (pushed < end && more()) {
+            const std::size_t n = file.read(pushed, std::min(chunk.size(), end - pushed),
+                                            chunk.data());
+            if (n == 0) break;
+            pushed += n;
+            decoder.push(chunk.data(), n);
+        }
+    };
+    push_until(span.read_end, [] { return true; });
+
+    // A frame that started here but has not ended is this chunk's to
+    // finish: the next one did not hear its preamble. Text past the longest
+    // frame means the preamble was noise. Unless max_frame_s is set, the
+    // rest of that frame is timed at the speed the sender was heard at.
+    reading_on = true;
+    const std::size_t max_chars = frame_bound_chars(cfg_.decode);
+    std::size_t read_cap = span.read_cap;
+    const double wpm = pipeline.unit_to_wpm(decoder.unit());
+    if (cfg_.max_frame_s <= 0.0 && wpm > 0.0) {
+        const std::size_t left = max_chars - std::min(max_chars, decoder.pending_text().size());
+        const double left_s = static_cast<double>(left) * kMaxUnitsPerChar * 1.2 / wpm;
+        read_cap = std::min(read_cap, span.read_end + static_cast<std::size_t>(
+                                                          std::llround(left_s * rate)));
+    }
+    push_until(read_cap, [&] {
+        return decoder.frame_open() && decoder.pending_text().size() <= max_chars;
+    });
+    decoder.flush();
+    return frames;
+}
+
+FileDecodeResult FileDecoder::decode(const std::string& path) const {
+    return std::move(decode_all({path}).front());
+}
+
+std::vector<FileDecodeResult> FileDecoder::decode_all(const std::vector<std::string>& paths,
+                                                      const FileCallback& on_file) const {
+    /// One recording in flight.
+    struct Job {
+        PcmFile                             file;
+        std::unique_ptr<DecodePipeline>     pipeline;
+        std::vector<Span>                   spans;
+        std::vector<std::vector<FileFrame>> found;   // per span
+        std::atomic<std::size_t>            left{0};
+    };
+    /// One span of one recording.
+    struct Task {
+        std::size_t job;
+        std::size_t span;
+    };
+
+    std::vector<FileDecodeResult> results(paths.size());
+    std::vector<std::unique_ptr<Job>> jobs(paths.size());
+    std::mutex report;
+    auto finished = [&](std::size_t i) {
+        if (!on_file) return;
+        std::lock_guard<std::mutex> lock(report);
+        on_file(results[i]);
+    };
+
+    double total_s = 0.0;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        results[i].path = paths[i];
+        jobs[i] = std::make_unique<Job>();
+        Job& job = *jobs[i];
+        if (!job.file.open(paths[i], cfg_.raw)) {
+            results[i].error = job.file.error();
+            finished(i);
+            continue;
+        }
+        results[i].opened     = true;
+        results[i].duration_s = job.file.duration_s();
+        total_s += results[i].duration_s;
+    }
+
+    // Without a set chunk length, cut the audio into kChunksPerWorker
+    // shares per thread; short files then stay whole.
+    WorkStealingPool pool(cfg_.threads);
+    double chunk_s = cfg_.chunk_s;
+    if (chunk_s <= 0.0) {
+        chunk_s = pool.workers() == 1
+                      ? total_s
+                      : std::max(total_s / static_cast<double>(kChunksPerWorker * pool.workers()),
+                                 kMinChunkMargins * seam_margin_s());
+    }
+
+    std::vector<Task> tasks;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (!results[i].opened) continue;
+        Job& job = *jobs[i];
+        const DecodeConfig rx = config_for(job.file.format().sample_rate);
+        job.pipeline = std::make_unique<DecodePipeline>(rx);
+        job.spans    = plan(job.file, rx, chunk_s);
+        job.found.resize(job.spans.size());
+        job.left     = job.spans.size();
+        results[i].chunks = job.spans.size();
+        for (std::size_t s = 0; s < job.spans.size(); ++s) tasks.push_back({i, s});
+    }
+
+    // The worker finishing a file's last span merges and reports it.
+    pool.run(tasks.size(), [&](std::size_t t, std::size_t) {
+        const Task& task = tasks[t];
+        Job& job = *jobs[task.job];
+        job.found[task.span] = decode_span(job.file, *job.pipeline, job.spans[task.span]);
+        if (job.left.fetch_sub(1) != 1) return;
+
+        FileDecodeResult& result = results[task.job];
+        result.frames = merge(job.found, 2.0 * seam_margin_s());
+        Reassembler reassembler(cfg_.decode.reassembly);
+        for (auto& frame : result.frames) job.pipeline->reassemble(reassembler, frame.result);
+        job.file.close();
+        finished(task.job);
+    });
+    return results;
+}
+
+std::vector<std::string> FileDecoder::expand(const std::vector<std::string>& args) {
+    std::vector<std::string> paths;
+    for (const auto& arg : args) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(arg, ec)) {
+            paths.push_back(arg);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::directory_iterator(arg, ec)) {
+            if (entry.is_regular_file(ec) && is_recording(entry.path())) {
+                found.push_back(entry.path().string());
+            }
+        }
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+    return paths;
+}
+
+} // namespace btccw::node
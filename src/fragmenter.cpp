@@ -0,0 +1,173 @@
+#include "fragmenter.hpp"
+
+#include <algorithm>
+
+#include <btccw/checksum.hpp>
+
+#include "fec_framer.hpp"
+
+namespace btccw::node {
+
+namespace {
+
+/// Two Base43 digits, most significant first.
+std::string encode_number(std::size_t value) {
+    return {FecFramer::char_of(static_cast<int>(value / 43)),
+            FecFramer::char_of(static_cast<int>(value % 43))};
+}
+
+/// Inverse of encode_number(); -1 on a character outside the alphabet.
+long decode_number(const std::string& text, std::size_t pos) {
+    const int hi = FecFramer::symbol_of(text[pos]);
+    const int lo = FecFramer::symbol_of(text[pos + 1]);
+    if (hi < 0 || lo < 0) return -1;
+    return hi * 43L + lo;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Fragmenter
+// ---------------------------------------------------------------------------
+
+std::string Fragmenter::tx_id(const std::string& payload) {
+    return btccw::Checksum::encode_crc(btccw::Checksum::crc32(payload));
+}
+
+std::vector<std::string> Fragmenter::split(const std::string& payload,
+                                           std::size_t fragment_chars) {
+    if (payload.empty() || fragment_chars == 0) return {};
+    const std::size_t count = (payload.size() + fragment_chars - 1) / fragment_chars;
+    if (count > kMaxFragments) return {};
+
+    // Even sizes, so the last fragment is not a short straggler.
+    const std::size_t base  = payload.size() / count;
+    const std::size_t extra = payload.size() % count;
+    const std::string id = tx_id(payload);
+
+    std::vector<std::string> out;
+    out.reserve(count);
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t size = base + (i < extra ? 1 : 0);
+        out.push_back(id + encode_number(i) + encode_number(count) +
+                      payload.substr(offset, size));
+        offset += size;
+    }
+    return out;
+}
+
+bool Fragmenter::parse(const std::string& payload, Fragment& out) {
+    if (payload.size() <= kHeaderLen) return false;
+    for (std::size_t i = 0; i < kIdLen; ++i) {
+        if (FecFramer::symbol_of(payload[i]) < 0) return false;
+    }
+    const long index = decode_number(payload, kIdLen);
+    const long count = decode_number(payload, kIdLen + 2);
+    if (index < 0 || count < 2 || index >= count) return false;
+
+    out.tx_id = payload.substr(0, kIdLen);
+    out.index = static_cast<std::size_t>(index);
+    out.count = static_cast<std::size_t>(count);
+    out.data  = payload.substr(kHeaderLen);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Reassembler
+// ---------------------------------------------------------------------------
+
+Reassembler::Reassembler(const ReassemblyConfig& cfg) : cfg_(cfg) {
+    cfg_.max_pending = std::max<std::size_t>(cfg_.max_pending, 1);
+}
+
+std::size_t Reassembler::expire(Clock::time_point now) {
+    const auto ttl = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(cfg_.expiry_s));
+    const std::size_t before = partials_.size();
+    partials_.erase(std::remove_if(partials_.begin(), partials_.end(),
+                                   [&](const Partial& p) { return now - p.last > ttl; }),
+                    partials_.end());
+    return before - partials_.size();
+}
+
+std::vector<std::size_t> Reassembler::missing(const std::string& tx_id) const {
+    std::vector<std::size_t> out;
+    for (const auto& p : partials_) {
+        if (p.tx_id != tx_id) continue;
+        for (std::size_t i = 0; i < p.parts.size(); ++i) {
+            if (p.parts[i].empty()) out.push_back(i);
+        }
+    }
+    return out;
+}
+
+ReassemblyStatus Reassembler::add(const Fragment& fragment, Clock::time_point now) {
+    expire(now);
+
+    ReassemblyStatus status;
+    status.tx_id = fragment.tx_id;
+    status.count = fragment.count;
+    if (fragment.count == 0 || fragment.index >= fragment.count || fragment.data.empty()) {
+        status.error = "not a fragment";
+        return status;
+    }
+    if (fragment.count > cfg_.max_fragments) {
+        status.error = "too many fragments (" + std::to_string(fragment.count) + ")";
+        return status;
+    }
+
+    auto it = std::find_if(partials_.begin(), partials_.end(),
+                           [&](const Partial& p) { return p.tx_id == fragment.tx_id; });
+    if (it != partials_.end() && it->parts.size() != fragment.count) {
+        status.error = "fragment count disagrees with earlier fragments";
+        status.received = it->received;
+        return status;
+    }
+    if (it == partials_.end()) {
+        if (partials_.size() == cfg_.max_pending) {
+            // Table full: the transaction heard from least recently goes.
+            partials_.erase(std::min_element(partials_.begin(), partials_.end(),
+                                             [](const Partial& a, const Partial& b) {
+                                                 return a.last < b.last;
+                                             }));
+        }
+        Partial p;
+        p.tx_id = fragment.tx_id;
+        p.parts.resize(fragment.count);
+        partials_.push_back(std::move(p));
+        it = partials_.end() - 1;
+    }
+
+    Partial& p = *it;
+    p.last = now;
+    if (p.parts[fragment.index].empty()) {
+        if (p.chars + fragment.data.size() > cfg_.max_chars) {
+            status.error = "transaction exceeds " + std::to_string(cfg_.max_chars) +
+                           " characters; dropped";
+            partials_.erase(it);
+            return status;
+        }
+        p.parts[fragment.index] = fragment.data;
+        p.chars += fragment.data.size();
+        ++p.received;
+    }
+    status.received = p.received;
+    if (p.received < p.parts.size()) return status;
+
+    std::string payload;
+    payload.reserve(p.chars);
+    for (const auto& part : p.parts) payload += part;
+    partials_.erase(it);
+
+    // Fragments from two transactions sharing an ID would join into garbage.
+    if (Fragmenter::tx_id(payload) != fragment.tx_id) {
+        status.error = "reassembled payload fails its ID check; dropped";
+        return status;
+    }
+    status.complete = true;
+    status.payload  = std::move(payload);
+    return status;
+}
+
+} // namespace btccw::node
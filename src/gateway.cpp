@@ -1,10 +1,19 @@
 #include "gateway.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
 #include <cstdio>
-#include <cstring>
+#include <iterator>
+#include <random>
 
 #include <curl/curl.h>
 
+#include <btccw/transaction.hpp>
+
+#include "json.hpp"
+#include "txid.hpp"
+
 namespace btccw::node {
 
 // ---------------------------------------------------------------------------
@@ -17,6 +26,45 @@ static std::size_t write_cb(char* ptr, std::size_t size, std::size_t nmemb,
     return size * nmemb;
 }
 
+/// One request (a single transaction, or an RPC batch), carried across
+/// its attempts. An attempt sends it to one endpoint or several.
+struct Gateway::Job {
+    std::vector<std::string> txs;
+    BatchCallback     done;
+    Clock::time_point submitted;
+    Clock::time_point due;            // earliest start of the next attempt
+    int               attempts = 0;
+    int               requests = 0;   // transfers started, over all attempts
+
+    // Current attempt.
+    std::vector<std::size_t>     order;         // endpoints, preferred first
+    std::size_t                  next    = 0;   // order[next] is sent to next
+    std::size_t                  running = 0;   // transfers under way
+    Clock::time_point            hedge_at;      // Hedged: send to order[next] by then
+    std::vector<BroadcastResult> held;          // a rejection, while another may accept
+    std::vector<BroadcastResult> last;          // the latest error
+};
+
+/// One HTTP request of a job to one endpoint; the strings must outlive it.
+struct Gateway::Transfer {
+    Job*              job      = nullptr;
+    std::size_t       endpoint = 0;
+    Clock::time_point started;
+    CURL*             curl    = nullptr;
+    curl_slist*       headers = nullptr;
+    std::string       url;
+    std::string       body;
+    std::string       userpwd;
+    std::string       response;
+};
+
+/// The same error for every transaction of a request.
+static std::vector<BroadcastResult> errors(std::size_t count, const std::string& error) {
+    std::vector<BroadcastResult> results(count);
+    for (auto& result : results) result.error = error;
+    return results;
+}
+
 // ---------------------------------------------------------------------------
 // Lifecycle
 // ---------------------------------------------------------------------------
@@ -27,16 +75,94 @@ Gateway::~Gateway() { close(); }
 
 bool Gateway::open(const GatewayConfig& cfg) {
     cfg_ = cfg;
+    cfg_.max_in_flight = std::max<std::size_t>(cfg_.max_in_flight, 1);
+    cfg_.max_attempts  = std::max(cfg_.max_attempts, 1);
+
+    if (cfg_.endpoints.empty()) {
+        BroadcastEndpoint single;
+        single.backend = cfg_.backend;
+        switch (cfg_.backend) {
+            case BroadcastBackend::MempoolSpace:
+                single.url = cfg_.mempool_url;
+                break;
+            case BroadcastBackend::BitcoinRPC:
+                single.url      = "http://" + cfg_.rpc_host + ":" + std::to_string(cfg_.rpc_port);
+                single.rpc_user = cfg_.rpc_user;
+                single.rpc_pass = cfg_.rpc_pass;
+                break;
+        }
+        cfg_.endpoints.push_back(std::move(single));
+    }
+    endpoints_.clear();
+    stats_.endpoints.clear();
+    has_rpc_ = false;
+    for (const auto& endpoint : cfg_.endpoints) {
+        endpoints_.emplace_back();
+        endpoints_.back().cfg = endpoint;
+        stats_.endpoints.emplace_back();
+        stats_.endpoints.back().url = endpoint.url;
+        has_rpc_ = has_rpc_ || endpoint.backend == BroadcastBackend::BitcoinRPC;
+    }
+    rng_.seed(std::random_device{}());
 
     if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
         std::fprintf(stderr, "[gateway] curl_global_init failed\n");
         return false;
     }
     initialized_ = true;
+
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        std::fprintf(stderr, "[gateway] curl_multi_init failed\n");
+        close();
+        return false;
+    }
+    // Keep one idle connection per transfer slot and endpoint for the next
+    // broadcast.
+    curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS,
+                      static_cast<long>(cfg_.max_in_flight * endpoints_.size()));
+
+    stopping_ = false;
+    worker_ = std::thread([this] { run(); });
     return true;
 }
 
 void Gateway::close() {
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        curl_multi_wakeup(multi_);
+        worker_.join();
+    }
+
+    // Whatever did not finish fails now, on this thread.
+    std::vector<std::unique_ptr<Job>> left;
+    for (auto& transfer : in_flight_) {
+        curl_multi_remove_handle(multi_, transfer->curl);
+        curl_easy_cleanup(transfer->curl);
+        curl_slist_free_all(transfer->headers);
+    }
+    in_flight_.clear();
+    for (auto& job : active_) left.push_back(std::move(job));
+    active_.clear();
+    for (auto& job : retrying_) left.push_back(std::move(job));
+    retrying_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& job : incoming_) left.push_back(std::move(job));
+        incoming_.clear();
+        retry_waiting_ = 0;
+    }
+    for (auto& job : left) fail(std::move(job), "gateway closed");
+
+    for (void* curl : idle_handles_) curl_easy_cleanup(curl);
+    idle_handles_.clear();
+    if (multi_) {
+        curl_multi_cleanup(multi_);
+        multi_ = nullptr;
+    }
     if (initialized_) {
         curl_global_cleanup();
         initialized_ = false;
@@ -44,110 +170,675 @@ void Gateway::close() {
 }
 
 // ---------------------------------------------------------------------------
-// Broadcast dispatcher
+// Submission
 // ---------------------------------------------------------------------------
 
 std::string Gateway::broadcast(std::string_view raw_tx_hex) {
     if (!initialized_) return {};
+    return broadcast_async(std::string(raw_tx_hex)).get().txid;
+}
 
-    switch (cfg_.backend) {
-        case BroadcastBackend::MempoolSpace:
-            return broadcast_mempool(raw_tx_hex);
-        case BroadcastBackend::BitcoinRPC:
-            return broadcast_rpc(raw_tx_hex);
+std::future<BroadcastResult> Gateway::broadcast_async(std::string raw_tx_hex) {
+    auto promise = std::make_shared<std::promise<BroadcastResult>>();
+    std::future<BroadcastResult> future = promise->get_future();
+    broadcast_async(std::move(raw_tx_hex), [promise](const BroadcastResult& result) {
+        promise->set_value(result);
+    });
+    return future;
+}
+
+void Gateway::broadcast_async(std::string raw_tx_hex, BroadcastCallback done) {
+    std::vector<std::string> txs;
+    txs.push_back(std::move(raw_tx_hex));
+    submit(std::move(txs), [done = std::move(done)](const std::vector<BroadcastResult>& r) {
+        if (done) done(r.front());
+    });
+}
+
+std::vector<BroadcastResult> Gateway::broadcast_batch(
+    const std::vector<std::string_view>& raw_txs) {
+    auto promise = std::make_shared<std::promise<std::vector<BroadcastResult>>>();
+    auto future  = promise->get_future();
+    broadcast_batch_async(std::vector<std::string>(raw_txs.begin(), raw_txs.end()),
+                          [promise](const std::vector<BroadcastResult>& results) {
+                              promise->set_value(results);
+                          });
+    return future.get();
+}
+
+void Gateway::broadcast_batch_async(std::vector<std::string> raw_txs, BatchCallback done) {
+    if (raw_txs.empty()) {
+        if (done) done({});
+        return;
+    }
+
+    // Bitcoin Core takes up to max_batch per request (and only Core
+    // endpoints get batches); mempool.space has no batch call, so without
+    // a Core endpoint each transaction is its own request (and they run in
+    // parallel).
+    const std::size_t per_request = has_rpc_ ? cfg_.max_batch : 1;
+
+    // The requests finish in any order; the last one delivers.
+    struct Joiner {
+        std::mutex                   mutex;
+        std::vector<BroadcastResult> results;
+        std::size_t                  pending = 0;
+        BatchCallback                done;
+    };
+    auto joiner = std::make_shared<Joiner>();
+    joiner->results.resize(raw_txs.size());
+    joiner->pending = (raw_txs.size() + per_request - 1) / per_request;
+    joiner->done    = std::move(done);
+
+    for (std::size_t first = 0; first < raw_txs.size(); first += per_request) {
+        const std::size_t count = std::min(per_request, raw_txs.size() - first);
+        std::vector<std::string> txs(std::make_move_iterator(raw_txs.begin() + first),
+                                     std::make_move_iterator(raw_txs.begin() + first + count));
+        submit(std::move(txs), [joiner, first](const std::vector<BroadcastResult>& part) {
+            bool last = false;
+            {
+                std::lock_guard<std::mutex> lock(joiner->mutex);
+                std::copy(part.begin(), part.end(), joiner->results.begin() + first);
+                last = --joiner->pending == 0;
+            }
+            if (last && joiner->done) joiner->done(joiner->results);
+        });
     }
-    return {};
+}
+
+void Gateway::submit(std::vector<std::string> txs, BatchCallback done) {
+    auto job = std::make_unique<Job>();
+    job->txs       = std::move(txs);
+    job->done      = std::move(done);
+    job->submitted = Clock::now();
+    job->due       = job->submitted;
+
+    const char* refused = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.submitted += job->txs.size();
+        if (!worker_.joinable() || stopping_) {
+            refused = "gateway not open";
+        } else if (incoming_.size() + retry_waiting_ >= cfg_.queue_depth) {
+            refused = "broadcast queue full";
+        } else {
+            incoming_.push_back(std::move(job));
+            stats_.queued     = incoming_.size() + retry_waiting_;
+            stats_.high_water = std::max(stats_.high_water, stats_.queued);
+        }
+    }
+    if (refused) {
+        fail(std::move(job), refused);
+        return;
+    }
+    curl_multi_wakeup(multi_);
+}
+
+GatewayStats Gateway::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GatewayStats stats = stats_;
+    const uint64_t done = stats.succeeded + stats.failed;
+    stats.mean_latency_s = done ? latency_sum_s_ / static_cast<double>(done) : 0.0;
+    return stats;
 }
 
 // ---------------------------------------------------------------------------
-// mempool.space  (POST raw hex as text/plain)
+// Worker
 // ---------------------------------------------------------------------------
 
-std::string Gateway::broadcast_mempool(std::string_view raw_tx_hex) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return {};
+void Gateway::run() {
+    for (;;) {
+        const auto now = Clock::now();
+
+        // 1. Start due retries (earliest first), then new submissions.
+        std::sort(retrying_.begin(), retrying_.end(),
+                  [](const auto& a, const auto& b) { return a->due < b->due; });
+        std::vector<std::unique_ptr<Job>> fresh;
+        std::size_t due = 0;
+        while (due < retrying_.size() && retrying_[due]->due <= now &&
+               active_.size() + fresh.size() < cfg_.max_in_flight) {
+            fresh.push_back(std::move(retrying_[due++]));
+        }
+        retrying_.erase(retrying_.begin(), retrying_.begin() + static_cast<long>(due));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return;
+            while (!incoming_.empty() &&
+                   active_.size() + fresh.size() < cfg_.max_in_flight) {
+                fresh.push_back(std::move(incoming_.front()));
+                incoming_.pop_front();
+            }
+        }
+        for (auto& job : fresh) begin(std::move(job));
+
+        // 2. Hedge the broadcasts whose endpoint is slow to answer.
+        if (cfg_.policy == BroadcastPolicy::Hedged) {
+            for (auto& job : active_) {
+                if (job->next < job->order.size() && job->hedge_at <= now) launch(*job);
+            }
+        }
+
+        // 3. Move bytes, then settle every transfer that finished.
+        int still_running = 0;
+        curl_multi_perform(multi_, &still_running);
+
+        int left = 0;
+        while (CURLMsg* msg = curl_multi_info_read(multi_, &left)) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            char* transfer = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+            settle(reinterpret_cast<Transfer*>(transfer), msg->data.result);
+        }
+
+        publish();
+
+        // 4. Sleep until there is socket activity, a submission (which
+        //    wakes the poll), or the next retry or hedge falls due. Not at
+        //    all if a slot freed up while submissions are waiting for one.
+        auto wait = std::chrono::milliseconds(1000);
+        const auto until = [](Clock::time_point when) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(when - Clock::now());
+        };
+        const bool slot_free = active_.size() < cfg_.max_in_flight;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (slot_free && !incoming_.empty()) wait = std::chrono::milliseconds(0);
+        }
+        if (!retrying_.empty() && slot_free) {
+            auto next = std::min_element(retrying_.begin(), retrying_.end(),
+                                         [](const auto& a, const auto& b) {
+                                             return a->due < b->due;
+                                         });
+            wait = std::min(wait, until((*next)->due));
+        }
+        if (cfg_.policy == BroadcastPolicy::Hedged) {
+            for (const auto& job : active_) {
+                if (job->next < job->order.size()) wait = std::min(wait, until(job->hedge_at));
+            }
+        }
+        if (wait.count() > 0) {
+            curl_multi_poll(multi_, nullptr, 0, static_cast<int>(wait.count()), nullptr);
+        }
+    }
+}
+
+std::vector<std::size_t> Gateway::preference(bool batch, std::size_t& healthy) const {
+    const auto now = Clock::now();
+    const auto sidelined = [&](std::size_t i) {
+        return endpoints_[i].errors_in_row >= cfg_.unhealthy_after &&
+               now < endpoints_[i].sidelined_until;
+    };
+
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < endpoints_.size(); ++i) {
+        if (!batch || endpoints_[i].cfg.backend == BroadcastBackend::BitcoinRPC) {
+            order.push_back(i);
+        }
+    }
+    // Healthy endpoints by latency, then the sidelined ones as a last
+    // resort. Ties keep configuration order.
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        const bool sa = sidelined(a);
+        const bool sb = sidelined(b);
+        if (sa != sb) return sb;
+        return endpoints_[a].latency_s < endpoints_[b].latency_s;
+    });
+    healthy = static_cast<std::size_t>(
+        std::count_if(order.begin(), order.end(), [&](std::size_t i) { return !sidelined(i); }));
+    return order;
+}
+
+void Gateway::begin(std::unique_ptr<Job> job) {
+    ++job->attempts;
+    std::size_t healthy = 0;
+    job->order = preference(job->txs.size() > 1, healthy);
+    job->next  = 0;
+    job->held.clear();
+    if (job->order.empty()) {
+        fail(std::move(job), "no endpoint takes RPC batches");
+        return;
+    }
+
+    Job* raw = job.get();
+    active_.push_back(std::move(job));
+
+    // Race sends to every healthy endpoint; the others start with one.
+    const std::size_t first =
+        cfg_.policy == BroadcastPolicy::Race ? std::max<std::size_t>(healthy, 1) : 1;
+    for (std::size_t started = 0; started < first; ++started) {
+        if (!launch(*raw)) break;
+    }
+    if (raw->running == 0) end_attempt(raw);
+}
+
+bool Gateway::launch(Job& job) {
+    while (job.next < job.order.size()) {
+        const std::size_t index = job.order[job.next++];
+        const BroadcastEndpoint& endpoint = endpoints_[index].cfg;
+
+        CURL* curl = nullptr;
+        if (!idle_handles_.empty()) {
+            curl = idle_handles_.back();
+            idle_handles_.pop_back();
+        } else {
+            curl = curl_easy_init();
+        }
+        if (!curl) {
+            job.last = errors(job.txs.size(), "curl_easy_init failed");
+            continue;
+        }
+
+        auto transfer = std::make_unique<Transfer>();
+        transfer->job      = &job;
+        transfer->endpoint = index;
+        transfer->curl     = curl;
+        transfer->url      = endpoint.url;
+
+        switch (endpoint.backend) {
+            case BroadcastBackend::MempoolSpace:
+                // mempool.space: POST raw hex as text/plain.
+                transfer->body    = job.txs.front();
+                transfer->headers = curl_slist_append(nullptr, "Content-Type: text/plain");
+                break;
+            case BroadcastBackend::BitcoinRPC:
+                // Bitcoin Core JSON-RPC: sendrawtransaction, one call per
+                // transaction; several go as one batch array.
+                transfer->body    = rpc_request(job.txs);
+                transfer->userpwd = endpoint.rpc_user + ":" + endpoint.rpc_pass;
+                curl_easy_setopt(curl, CURLOPT_USERPWD, transfer->userpwd.c_str());
+                transfer->headers = curl_slist_append(nullptr, "Content-Type: application/json");
+                break;
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer->body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer->body.size()));
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->response);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, cfg_.connect_timeout_ms);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, cfg_.timeout_ms);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+
+        if (curl_multi_add_handle(multi_, curl) != CURLM_OK) {
+            release(*transfer);
+            job.last = errors(job.txs.size(), "curl_multi_add_handle failed");
+            continue;
+        }
+        transfer->started = Clock::now();
+        job.hedge_at      = transfer->started + std::chrono::milliseconds(cfg_.hedge_delay_ms);
+        ++job.running;
+        ++job.requests;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.endpoints[index].requests;
+        }
+        in_flight_.push_back(std::move(transfer));
+        return true;
+    }
+    return false;
+}
 
-    std::string response;
-    std::string body(raw_tx_hex);
+void Gateway::release(Transfer& transfer) {
+    curl_slist_free_all(transfer.headers);
+    transfer.headers = nullptr;
+
+    // A reset handle keeps its live connections and caches, so the next
+    // broadcast skips the TCP and TLS handshakes.
+    curl_easy_reset(transfer.curl);
+    if (idle_handles_.size() < cfg_.max_in_flight * endpoints_.size()) {
+        idle_handles_.push_back(transfer.curl);
+    } else {
+        curl_easy_cleanup(transfer.curl);
+    }
+    transfer.curl = nullptr;
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, cfg_.mempool_url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+void Gateway::settle(Transfer* finished, int curl_result) {
+    auto it = std::find_if(in_flight_.begin(), in_flight_.end(),
+                           [&](const auto& transfer) { return transfer.get() == finished; });
+    if (it == in_flight_.end()) return;
+    std::unique_ptr<Transfer> transfer = std::move(*it);
+    in_flight_.erase(it);
+    Job* job = transfer->job;
+    --job->running;
+
+    long http_status = 0;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &http_status);
+    curl_multi_remove_handle(multi_, transfer->curl);
+    release(*transfer);
+
+    std::vector<BroadcastResult> results(job->txs.size());
+    for (auto& result : results) {
+        result.http_status = http_status;
+        result.endpoint    = transfer->url;
+    }
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: text/plain");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    bool retry = true;
+    if (curl_result != CURLE_OK) {
+        const char* error = curl_easy_strerror(static_cast<CURLcode>(curl_result));
+        for (auto& result : results) result.error = error;
+    } else {
+        switch (endpoints_[transfer->endpoint].cfg.backend) {
+            case BroadcastBackend::MempoolSpace: retry = parse_mempool(*transfer, results.front()); break;
+            case BroadcastBackend::BitcoinRPC:   retry = parse_rpc(*transfer, results);             break;
+        }
+    }
+    const double elapsed =
+        std::chrono::duration<double>(Clock::now() - transfer->started).count();
+    record(transfer->endpoint, retry ? Outcome::Error : Outcome::Answered, elapsed);
+
+    // Only a failure of the request as a whole is retried; per-transaction
+    // RPC errors are final. A rejection waits for the job's other
+    // transfers, in case one of them is accepted.
+    if (!retry) {
+        const bool accepted = std::all_of(results.begin(), results.end(),
+                                          [](const auto& result) { return result.success; });
+        if (accepted || job->running == 0) {
+            finish(job, std::move(results));
+        } else if (job->held.empty()) {
+            job->held = std::move(results);
+        }
+        return;
+    }
 
-    CURLcode res = curl_easy_perform(curl);
+    // Fail over to the next endpoint now rather than at the hedge. A race
+    // already has every healthy endpoint running; it falls back on the
+    // sidelined ones only when all of those failed.
+    job->last = std::move(results);
+    if (job->held.empty() && (cfg_.policy != BroadcastPolicy::Race || job->running == 0) &&
+        job->next < job->order.size()) {
+        std::fprintf(stderr, "[gateway] %s failed (%s); trying the next endpoint\n",
+                     transfer->url.c_str(), job->last.front().error.c_str());
+        launch(*job);
+    }
+    if (job->running == 0) end_attempt(job);
+}
 
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+void Gateway::end_attempt(Job* job) {
+    if (!job->held.empty()) {
+        finish(job, std::move(job->held));
+        return;
+    }
+    if (job->attempts >= cfg_.max_attempts) {
+        finish(job, std::move(job->last));
+        return;
+    }
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+    std::unique_ptr<Job> owned = take(job);
+    const auto wait = backoff(owned->attempts, static_cast<uint32_t>(rng_()));
+    std::fprintf(stderr, "[gateway] attempt %d failed (%s); retrying in %.1f s\n",
+                 owned->attempts, owned->last.empty() ? "" : owned->last.front().error.c_str(),
+                 std::chrono::duration<double>(wait).count());
+    owned->due = Clock::now() + wait;
+    retrying_.push_back(std::move(owned));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.retries;
+    }
+    publish();
+}
 
-    if (res != CURLE_OK || http_code != 200) {
-        std::fprintf(stderr, "[gateway] mempool broadcast failed (HTTP %ld): %s\n",
-                     http_code, response.c_str());
-        return {};
+void Gateway::finish(Job* job, std::vector<BroadcastResult> results) {
+    // Whatever else is still running for it has lost.
+    const auto now = Clock::now();
+    for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+        Transfer& transfer = **it;
+        if (transfer.job != job) {
+            ++it;
+            continue;
+        }
+        curl_multi_remove_handle(multi_, transfer.curl);
+        record(transfer.endpoint, Outcome::Cancelled,
+               std::chrono::duration<double>(now - transfer.started).count());
+        release(transfer);
+        it = in_flight_.erase(it);
     }
+    complete(take(job), std::move(results));
+    publish();
+}
 
-    return response; // txid
+std::unique_ptr<Gateway::Job> Gateway::take(Job* job) {
+    auto it = std::find_if(active_.begin(), active_.end(),
+                           [&](const auto& candidate) { return candidate.get() == job; });
+    std::unique_ptr<Job> owned = std::move(*it);
+    active_.erase(it);
+    return owned;
 }
 
-// ---------------------------------------------------------------------------
-// Bitcoin Core JSON-RPC  (sendrawtransaction)
-// ---------------------------------------------------------------------------
+void Gateway::record(std::size_t endpoint, Outcome outcome, double elapsed_s) {
+    // Latency is smoothed so one slow answer does not reorder the
+    // endpoints, and the first answer seeds it.
+    constexpr double kSmoothing = 0.2;
+    Endpoint& e = endpoints_[endpoint];
+    const auto smooth = [&] {
+        e.latency_s = e.latency_s > 0.0 ? e.latency_s + kSmoothing * (elapsed_s - e.latency_s)
+                                        : elapsed_s;
+    };
+    switch (outcome) {
+        case Outcome::Answered:
+            e.errors_in_row = 0;
+            smooth();
+            break;
+        case Outcome::Error:
+            if (++e.errors_in_row >= cfg_.unhealthy_after) {
+                e.sidelined_until =
+                    Clock::now() + std::chrono::milliseconds(cfg_.unhealthy_cooldown_ms);
+            }
+            break;
+        case Outcome::Cancelled:
+            // It would have taken at least this long, so an endpoint that
+            // keeps losing races stops looking fast.
+            if (elapsed_s > e.latency_s) smooth();
+            break;
+    }
 
-std::string Gateway::broadcast_rpc(std::string_view raw_tx_hex) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return {};
+    std::lock_guard<std::mutex> lock(mutex_);
+    EndpointStats& stats = stats_.endpoints[endpoint];
+    switch (outcome) {
+        case Outcome::Answered:  ++stats.answered;  break;
+        case Outcome::Error:     ++stats.errors;    break;
+        case Outcome::Cancelled: ++stats.cancelled; break;
+    }
+    stats.latency_s = e.latency_s;
+    stats.healthy   = e.errors_in_row < cfg_.unhealthy_after;
+}
 
-    std::string response;
+void Gateway::publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    retry_waiting_    = retrying_.size();
+    stats_.in_flight  = in_flight_.size();
+    stats_.queued     = incoming_.size() + retry_waiting_;
+    stats_.high_water = std::max(stats_.high_water, stats_.queued);
+}
 
-    // Build JSON-RPC payload.
-    std::string payload =
-        "{\"jsonrpc\":\"1.0\",\"id\":\"btccw\","
-        "\"method\":\"sendrawtransaction\",\"params\":[\"";
-    payload.append(raw_tx_hex);
-    payload += "\"]}";
+void Gateway::fail(std::unique_ptr<Job> job, const std::string& error) {
+    std::vector<BroadcastResult> results = errors(job->txs.size(), error);
+    complete(std::move(job), std::move(results));
+}
 
-    std::string url = "http://" + cfg_.rpc_host + ":" +
-                      std::to_string(cfg_.rpc_port);
+void Gateway::complete(std::unique_ptr<Job> job, std::vector<BroadcastResult> results) {
+    const double latency = std::chrono::duration<double>(Clock::now() - job->submitted).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& result : results) {
+            result.attempts  = job->requests;
+            result.latency_s = latency;
+            ++(result.success ? stats_.succeeded : stats_.failed);
+            latency_sum_s_ += latency;
+        }
+        stats_.max_latency_s = std::max(stats_.max_latency_s, latency);
+    }
+    for (const auto& result : results) {
+        if (result.success) continue;
+        std::fprintf(stderr, "[gateway] broadcast failed after %d request(s): %s\n",
+                     result.attempts, result.error.c_str());
+    }
+    if (job->done) job->done(results);
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+// ---------------------------------------------------------------------------
+// Responses
+// ---------------------------------------------------------------------------
 
-    std::string userpwd = cfg_.rpc_user + ":" + cfg_.rpc_pass;
-    curl_easy_setopt(curl, CURLOPT_USERPWD, userpwd.c_str());
+/// Transport-level trouble worth another attempt: overload or server fault.
+static bool retryable_status(long http_status) {
+    return http_status == 429 || http_status >= 500;
+}
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+/// A refusal meaning the network already has the transaction. Sending is
+/// not idempotent: after a timeout or 5xx the node may well have taken it,
+/// and the retry is then told so.
+static bool already_known(std::string_view reason) {
+    static constexpr std::string_view kMarkers[] = {
+        "txn-already-known",          // Core: in the mempool or recently seen
+        "txn-already-in-mempool",
+        "already in mempool",         // mempool.space
+        "already in block chain",     // Core, RPC -27
+        "already in utxo set",        // Core, RPC -27
+    };
+    std::string lower(reason);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return std::any_of(std::begin(kMarkers), std::end(kMarkers), [&](std::string_view marker) {
+        return lower.find(marker) != std::string::npos;
+    });
+}
 
-    CURLcode res = curl_easy_perform(curl);
+/// Report `raw_tx`, which the network already has, as broadcast. The
+/// refusal carries no txid, so it is computed; the error stands if that
+/// fails.
+static void accept_known(const std::string& raw_tx, BroadcastResult& result) {
+    std::string txid;
+    if (!compute_txid(btccw::Transaction::hex_to_bytes(raw_tx), txid)) return;
+    result.success = true;
+    result.txid    = std::move(txid);
+    result.error.clear();
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+bool Gateway::parse_mempool(const Transfer& transfer, BroadcastResult& result) const {
+    if (result.http_status != 200) {
+        result.error = "HTTP " + std::to_string(result.http_status) + ": " + transfer.response;
+        if (already_known(transfer.response)) {
+            accept_known(transfer.job->txs.front(), result);
+            if (result.success) return false;
+        }
+        return retryable_status(result.http_status);
+    }
+    // The body is the txid.
+    std::string txid = transfer.response;
+    while (!txid.empty() && std::isspace(static_cast<unsigned char>(txid.back()))) {
+        txid.pop_back();
+    }
+    result.success = !txid.empty();
+    result.txid    = std::move(txid);
+    if (!result.success) result.error = "empty response";
+    return false;
+}
 
-    if (res != CURLE_OK) {
-        std::fprintf(stderr, "[gateway] RPC broadcast failed: %s\n",
-                     curl_easy_strerror(res));
-        return {};
+std::string Gateway::rpc_request(const std::vector<std::string>& txs) {
+    // One pass into a buffer sized up front: the hex dominates.
+    std::size_t bytes = 0;
+    for (const auto& tx : txs) bytes += tx.size() + 80;
+
+    JsonWriter json(bytes + 2);
+    const bool batch = txs.size() > 1;
+    if (batch) json.begin_array();
+    for (std::size_t i = 0; i < txs.size(); ++i) {
+        json.begin_object()
+            .key("jsonrpc").value("1.0")
+            .key("id").value(static_cast<long long>(i))
+            .key("method").value("sendrawtransaction")
+            .key("params").begin_array().value(txs[i]).end_array()
+            .end_object();
     }
+    if (batch) json.end_array();
+    return json.take();
+}
 
-    // Minimal parse: look for "result":"<txid>"
-    auto pos = response.find("\"result\":\"");
-    if (pos == std::string::npos) {
-        std::fprintf(stderr, "[gateway] RPC error: %s\n", response.c_str());
-        return {};
+/// RPC_VERIFY_ALREADY_IN_CHAIN: the transaction is already confirmed.
+constexpr double kRpcAlreadyInChain = -27;
+
+/// One JSON-RPC reply to sending `raw_tx`: the txid, or the node's reason
+/// for refusing it. A refusal because the node already has it is a
+/// success. `raw_tx` is empty when the reply is to a batch as a whole.
+static void read_rpc_reply(const JsonValue& reply, const std::string& raw_tx,
+                           BroadcastResult& result) {
+    const JsonValue* error = reply.find("error");
+    if (error && error->is_object()) {
+        const JsonValue* code    = error->find("code");
+        const JsonValue* message = error->find("message");
+        const std::string text = message && message->is_string() ? message->as_string() : "";
+        result.error = "RPC error " +
+                       (code && code->is_number()
+                            ? std::to_string(static_cast<long long>(code->as_number()))
+                            : std::string("?")) +
+                       ": " + text;
+        if (!raw_tx.empty() &&
+            ((code && code->is_number() && code->as_number() == kRpcAlreadyInChain) ||
+             already_known(text))) {
+            accept_known(raw_tx, result);
+        }
+        return;
     }
-    pos += 10; // skip past "result":"
-    auto end = response.find('"', pos);
-    return response.substr(pos, end - pos);
+    const JsonValue* txid = reply.find("result");
+    if (txid && txid->is_string() && !txid->as_string().empty()) {
+        result.success = true;
+        result.txid    = txid->as_string();
+    } else {
+        result.error = "RPC reply without a txid";
+    }
+}
+
+bool Gateway::parse_rpc(const Transfer& transfer,
+                        std::vector<BroadcastResult>& results) const {
+    JsonValue doc;
+    if (!JsonValue::parse(transfer.response, doc)) {
+        // Not JSON-RPC at all (a proxy page, an auth failure): the request
+        // failed as a whole.
+        const std::string error = "RPC HTTP " + std::to_string(results.front().http_status) +
+                                  ": " + transfer.response.substr(0, 200);
+        for (auto& result : results) result.error = error;
+        return retryable_status(results.front().http_status);
+    }
+
+    if (doc.is_array()) {
+        // Batch replies may come in any order; the id says whose each is.
+        for (const auto& reply : doc.items()) {
+            const JsonValue* id = reply.find("id");
+            if (!id || !id->is_number()) continue;
+            // Only ids we sent: whole numbers below the batch size.
+            const double value = id->as_number();
+            if (!std::isfinite(value) || value < 0 || value >= static_cast<double>(results.size()) ||
+                value != std::floor(value)) {
+                continue;
+            }
+            const auto index = static_cast<std::size_t>(value);
+            read_rpc_reply(reply, transfer.job->txs[index], results[index]);
+        }
+    } else if (doc.is_object() && results.size() == 1) {
+        read_rpc_reply(doc, transfer.job->txs.front(), results.front());
+    } else if (doc.is_object()) {
+        // One reply to a batch is about the request as a whole.
+        BroadcastResult whole;
+        read_rpc_reply(doc, {}, whole);
+        for (auto& result : results) {
+            result.error = whole.success ? "single RPC reply to a batch" : whole.error;
+        }
+    }
+
+    for (auto& result : results) {
+        if (!result.success && result.error.empty()) result.error = "no RPC reply";
+    }
+    return false;
+}
+
+Gateway::Clock::duration Gateway::backoff(int attempt, uint32_t random) const {
+    const int shift = std::min(attempt - 1, 20);
+    const long cap = std::min(cfg_.retry_max_ms, cfg_.retry_base_ms << shift);
+    return std::chrono::milliseconds(cap > 0 ? random % static_cast<uint32_t>(cap + 1) : 0);
 }
 
 } // namespace btccw::node
@@ -4,78 +4,204 @@
 #include <cmath>
 #include <numeric>
 
+#include "goertzel_kernel.hpp"
+
 namespace btccw::node {
 
 GoertzelDetector::GoertzelDetector(double sample_rate, double tone_freq,
-                                   std::size_t block_size, double threshold)
+                                   std::size_t block_size, double threshold,
+                                   std::size_t hop_size, ThresholdMode mode,
+                                   std::size_t noise_window)
     : sample_rate_(sample_rate),
       tone_freq_(tone_freq),
       block_size_(block_size),
-      threshold_(threshold) {
+      threshold_(threshold),
+      hop_size_((hop_size == 0 || hop_size > block_size) ? block_size : hop_size),
+      mode_(mode),
+      noise_window_(noise_window) {
     // k = round(N * f / fs) — integer bin index for bin-centered detection
     double k = std::round(block_size_ * tone_freq_ / sample_rate_);
-    coeff_ = 2.0 * std::cos(2.0 * M_PI * k / static_cast<double>(block_size_));
-}
+    double w = 2.0 * M_PI * k / static_cast<double>(block_size_);
+    coeff_ = 2.0 * std::cos(w);
 
-double GoertzelDetector::magnitude(const float* samples, std::size_t count) const {
-    double s0 = 0.0;
-    double s1 = 0.0;
-    double s2 = 0.0;
-
-    for (std::size_t i = 0; i < count; ++i) {
-        s0 = static_cast<double>(samples[i]) + coeff_ * s1 - s2;
-        s2 = s1;
-        s1 = s0;
+    if (sliding()) {
+        rotate_ = std::polar(1.0, w);
+        twiddle_.resize(block_size_);
+        for (std::size_t m = 0; m < block_size_; ++m) {
+            twiddle_[m] = std::polar(1.0, -w * static_cast<double>(m));
+        }
+        resync_hops_ = std::max<std::size_t>(1, kResyncWindows * block_size_ / hop_size_);
     }
-
-    // Power = s1^2 + s2^2 - coeff * s1 * s2
-    return s1 * s1 + s2 * s2 - coeff_ * s1 * s2;
 }
 
-std::vector<bool> GoertzelDetector::detect(const std::vector<float>& pcm) const {
+std::vector<double> GoertzelDetector::magnitudes(const std::vector<float>& pcm) const {
     if (pcm.empty() || block_size_ == 0) return {};
 
     std::size_t num_blocks = pcm.size() / block_size_;
     if (num_blocks == 0) return {};
 
-    // Compute magnitudes for all blocks.
-    std::vector<double> mags(num_blocks);
-    for (std::size_t i = 0; i < num_blocks; ++i) {
-        mags[i] = magnitude(pcm.data() + i * block_size_, block_size_);
+    std::vector<double> mags;
+    if (sliding()) {
+        // Same incremental path as streaming, run over the whole buffer.
+        StreamState st;
+        mags.reserve((pcm.size() - block_size_) / hop_size_ + 1);
+        feed(st, pcm.data(), pcm.size(), mags);
+        return mags;
+    }
+
+    // Compute magnitudes for all blocks (SIMD across blocks where available).
+    mags.resize(num_blocks);
+    GoertzelKernel::block_powers(pcm.data(), num_blocks, block_size_,
+                                 block_size_, coeff_, mags.data());
+    return mags;
+}
+
+ToneBits GoertzelDetector::detect(const std::vector<float>& pcm) const {
+    return decide(magnitudes(pcm));
+}
+
+ToneBits GoertzelDetector::decide(const std::vector<double>& mags) const {
+    if (mags.empty()) return {};
+    return apply_threshold(mags, threshold_, mode_, noise_window_);
+}
+
+ToneBits GoertzelDetector::apply_threshold(const std::vector<double>& mags,
+                                           double threshold,
+                                           ThresholdMode mode,
+                                           std::size_t noise_window) {
+    if (mags.empty()) return {};
+    const std::size_t num_blocks = mags.size();
+
+    ToneBits result(num_blocks);
+    bool state = false; // start OFF
+
+    // Adaptive: every block gets the thresholds of its own neighbourhood.
+    if (threshold <= 0.0 && mode == ThresholdMode::Adaptive) {
+        NoiseTracker tracker(noise_window);
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            tracker.update(mags[i]);
+            result.set(i, tracker.tone());
+        }
+        return result;
     }
 
     // Determine threshold: use provided value or auto-compute from median.
-    double thresh_on = threshold_;
+    double thresh_on = threshold;
     if (thresh_on <= 0.0) {
-        std::vector<double> sorted = mags;
-        std::sort(sorted.begin(), sorted.end());
-        double median = sorted[sorted.size() / 2];
-        thresh_on = median * 3.0;
+        thresh_on = ThresholdEstimator::median_of(mags, mode) * 3.0;
     }
 
     // Hysteresis: OFF threshold is 70% of ON threshold.
-    double thresh_off = thresh_on * 0.7;
+    const Thresholds t{thresh_on, thresh_on * 0.7};
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        state = hysteresis(state, mags[i], t);
+        result.set(i, state);
+    }
 
-    // Apply hysteresis thresholding.
-    std::vector<bool> result(num_blocks);
-    bool state = false; // start OFF
+    return result;
+}
 
-    for (std::size_t i = 0; i < num_blocks; ++i) {
-        if (state) {
-            // Currently ON — stay ON unless below OFF threshold.
-            if (mags[i] < thresh_off) {
-                state = false;
-            }
-        } else {
-            // Currently OFF — turn ON if above ON threshold.
-            if (mags[i] >= thresh_on) {
-                state = true;
+// ---------------------------------------------------------------------------
+// Streaming
+// ---------------------------------------------------------------------------
+
+Thresholds GoertzelDetector::stream_thresholds(StreamState& st, double mag) const {
+    if (threshold_ > 0.0) return {threshold_, threshold_ * 0.7};
+
+    // A default-constructed state picks up this detector's estimator.
+    if (st.estimator.mode() != mode_) st.estimator = ThresholdEstimator(mode_);
+
+    // Same rule as detect(), on the running median.
+    st.estimator.add(mag);
+    const double on = st.estimator.median() * 3.0;
+    return {on, on * 0.7};
+}
+
+std::complex<double> GoertzelDetector::window_bin(const StreamState& st) const {
+    // Oldest sample is at window_pos and takes twiddle index 0.
+    std::complex<double> acc;
+    std::size_t pos = st.window_pos;
+    for (std::size_t m = 0; m < block_size_; ++m) {
+        acc += static_cast<double>(st.window[pos]) * twiddle_[m];
+        if (++pos == block_size_) pos = 0;
+    }
+    return acc;
+}
+
+void GoertzelDetector::feed(StreamState& st, const float* samples,
+                            std::size_t count, std::vector<double>& mags) const {
+    if (!sliding()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            double s0 = static_cast<double>(samples[i]) + coeff_ * st.s1 - st.s2;
+            st.s2 = st.s1;
+            st.s1 = s0;
+
+            if (++st.filled < block_size_) continue;
+
+            // Block complete: emit, then restart the recurrence.
+            mags.push_back(power(st.s1, st.s2));
+            st.s1 = st.s2 = 0.0;
+            st.filled = 0;
+        }
+        return;
+    }
+
+    if (st.window.size() != block_size_) st.window.assign(block_size_, 0.0f);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float x = samples[i];
+
+        // First window: fill, then compute the bin directly.
+        if (st.filled < block_size_) {
+            st.window[st.filled++] = x;
+            if (st.filled == block_size_) {
+                st.window_pos = 0;
+                st.bin = window_bin(st);
+                mags.push_back(std::norm(st.bin));
             }
+            continue;
         }
-        result[i] = state;
+
+        // Slide by one sample: X <- (X + x_new - x_old) * e^{j2πk/N}.
+        const float oldest = st.window[st.window_pos];
+        st.window[st.window_pos] = x;
+        if (++st.window_pos == block_size_) st.window_pos = 0;
+        st.bin = (st.bin + (static_cast<double>(x) - static_cast<double>(oldest))) * rotate_;
+
+        if (++st.since_hop < hop_size_) continue;
+        st.since_hop = 0;
+
+        if (++st.since_resync >= resync_hops_) {
+            st.since_resync = 0;
+            st.bin = window_bin(st);
+        }
+        mags.push_back(std::norm(st.bin));
     }
+}
 
-    return result;
+void GoertzelDetector::push(StreamState& st, const float* samples,
+                            std::size_t count, ToneBits& out) const {
+    if (block_size_ == 0) return;
+
+    st.mags.clear();
+    feed(st, samples, count, st.mags);
+
+    const bool adaptive = threshold_ <= 0.0 && mode_ == ThresholdMode::Adaptive;
+    if (adaptive && st.tracker.window() != noise_window_) {
+        st.tracker = NoiseTracker(noise_window_);
+    }
+
+    for (double mag : st.mags) {
+        if (adaptive) {
+            // The tracker keeps its own hysteresis state.
+            st.tracker.update(mag);
+            st.tone = st.tracker.tone();
+        } else {
+            // Hysteresis against the running thresholds.
+            st.tone = hysteresis(st.tone, mag, stream_thresholds(st, mag));
+        }
+        out.push_back(st.tone);
+    }
 }
 
 } // namespace btccw::node
@@ -0,0 +1,121 @@
+#include "goertzel_bank.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "goertzel.hpp"
+#include "goertzel_kernel.hpp"
+
+namespace btccw::node {
+
+GoertzelBank::GoertzelBank(double sample_rate, std::vector<double> freqs,
+                           std::size_t block_size, double threshold,
+                           std::size_t hop_size, ThresholdMode mode,
+                           std::size_t noise_window)
+    : sample_rate_(sample_rate),
+      freqs_(std::move(freqs)),
+      block_size_(block_size),
+      threshold_(threshold),
+      hop_size_((hop_size == 0 || hop_size > block_size) ? block_size : hop_size),
+      mode_(mode),
+      noise_window_(noise_window) {
+    coeffs_.reserve(freqs_.size());
+    for (double f : freqs_) {
+        coeffs_.push_back(2.0 * std::cos(2.0 * M_PI * f / sample_rate_));
+    }
+
+    if (sliding()) {
+        const std::size_t nb = freqs_.size();
+        const auto n = static_cast<double>(block_size_);
+        rotate_.resize(2 * nb);
+        leave_.resize(2 * nb);
+        for (std::size_t b = 0; b < nb; ++b) {
+            const double w = 2.0 * M_PI * freqs_[b] / sample_rate_;
+            rotate_[b]      = std::cos(w);
+            rotate_[nb + b] = std::sin(w);
+            leave_[b]       = std::cos(w * n);
+            leave_[nb + b]  = std::sin(w * n);
+        }
+        resync_hops_ = std::max<std::size_t>(
+            1, GoertzelDetector::kResyncWindows * block_size_ / hop_size_);
+    }
+}
+
+std::vector<double> GoertzelBank::spread(double lo_hz, double hi_hz,
+                                         std::size_t count) {
+    std::vector<double> freqs;
+    if (count == 0) return freqs;
+    if (count == 1) return {0.5 * (lo_hz + hi_hz)};
+
+    double step = (hi_hz - lo_hz) / static_cast<double>(count - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        freqs.push_back(lo_hz + step * static_cast<double>(i));
+    }
+    return freqs;
+}
+
+std::vector<double> GoertzelBank::magnitudes(const std::vector<float>& pcm) const {
+    if (pcm.size() < block_size_ || block_size_ == 0 || freqs_.empty()) return {};
+
+    std::size_t num_blocks = (pcm.size() - block_size_) / hop_size_ + 1;
+    std::vector<double> mags(num_blocks * bins());
+    std::vector<double> state(2 * bins());
+    if (!sliding()) {
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            GoertzelKernel::bin_powers(pcm.data() + i * hop_size_, block_size_,
+                                       coeffs_.data(), bins(), state.data(),
+                                       mags.data() + i * bins());
+        }
+        return mags;
+    }
+
+    // Each bin slides as Y = Σ x[m] e^{jw(N-1-m)} over the window, the
+    // value the Goertzel recurrence ends on.
+    const std::size_t nb = bins();
+    std::vector<double> bin(2 * nb);
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        double* out = mags.data() + i * nb;
+
+        if (i % resync_hops_ == 0) {
+            // Direct block; its last s1, s2 give Y = s1 - e^{-jw} s2.
+            GoertzelKernel::bin_powers(pcm.data() + i * hop_size_, block_size_,
+                                       coeffs_.data(), nb, state.data(), out);
+            for (std::size_t b = 0; b < nb; ++b) {
+                bin[b]      = state[b] - rotate_[b] * state[nb + b];
+                bin[nb + b] = rotate_[nb + b] * state[nb + b];
+            }
+            continue;
+        }
+
+        const float* oldest = pcm.data() + (i - 1) * hop_size_;
+        GoertzelKernel::slide_bins(oldest, oldest + block_size_, hop_size_,
+                                   rotate_.data(), leave_.data(), nb, bin.data());
+        for (std::size_t b = 0; b < nb; ++b) {
+            out[b] = bin[b] * bin[b] + bin[nb + b] * bin[nb + b];
+        }
+    }
+    return mags;
+}
+
+std::vector<ToneBits> GoertzelBank::detect(const std::vector<float>& pcm) const {
+    std::vector<double> mags = magnitudes(pcm);
+    if (mags.empty()) return {};
+
+    const std::size_t nb         = bins();
+    const std::size_t num_blocks = mags.size() / nb;
+
+    // Each bin gets its own threshold, exactly as a lone detector would.
+    std::vector<ToneBits> tones(nb);
+    std::vector<double> column(num_blocks);
+    for (std::size_t b = 0; b < nb; ++b) {
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            column[i] = mags[i * nb + b];
+        }
+        tones[b] = GoertzelDetector::apply_threshold(column, threshold_, mode_,
+                                                   noise_window_);
+    }
+    return tones;
+}
+
+} // namespace btccw::node
@@ -0,0 +1,618 @@
+#include "goertzel_kernel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BTCCW_GOERTZEL_X86 1
+#include <immintrin.h>
+#endif
+
+// Bit-exactness with the scalar reference relies on every kernel doing
+//   s0    = (x + c * s1) - s2
+//   power = (s1 * s1 + s2 * s2) - (c * s1) * s2
+//   Y'    = (e^{jw} * Y) + (x_new - e^{jwN} * x_old)   (slide_bins)
+// as separate multiplies and adds. This file is built with
+// -ffp-contract=off so the compiler cannot fuse them into FMAs.
+
+namespace btccw::node {
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+// ---------------------------------------------------------------------------
+
+void GoertzelKernel::block_powers_scalar(const float* pcm, std::size_t count,
+                                         std::size_t block_size,
+                                         std::size_t stride, double coeff,
+                                         double* out) {
+    for (std::size_t b = 0; b < count; ++b) {
+        const float* samples = pcm + b * stride;
+        double s1 = 0.0;
+        double s2 = 0.0;
+        for (std::size_t i = 0; i < block_size; ++i) {
+            double s0 = static_cast<double>(samples[i]) + coeff * s1 - s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        out[b] = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    }
+}
+
+void GoertzelKernel::bin_powers_scalar(const float* samples,
+                                       std::size_t block_size,
+                                       const double* coeffs, std::size_t bins,
+                                       double* state, double* out) {
+    double* p1 = state;
+    double* p2 = state + bins;
+    std::fill(state, state + 2 * bins, 0.0);
+
+    for (std::size_t i = 0; i < block_size; ++i) {
+        const double x = static_cast<double>(samples[i]);
+        for (std::size_t b = 0; b < bins; ++b) {
+            double s0 = x + coeffs[b] * p1[b] - p2[b];
+            p2[b] = p1[b];
+            p1[b] = s0;
+        }
+    }
+
+    for (std::size_t b = 0; b < bins; ++b) {
+        out[b] = p1[b] * p1[b] + p2[b] * p2[b] - coeffs[b] * p1[b] * p2[b];
+    }
+}
+
+void GoertzelKernel::slide_bins_scalar(const float* oldest, const float* newest,
+                                       std::size_t count, const double* rotate,
+                                       const double* leave, std::size_t bins,
+                                       double* bin) {
+    double* re = bin;
+    double* im = bin + bins;
+    for (std::size_t t = 0; t < count; ++t) {
+        const double x_old = static_cast<double>(oldest[t]);
+        const double x_new = static_cast<double>(newest[t]);
+        for (std::size_t b = 0; b < bins; ++b) {
+            // The sample terms do not depend on Y: off the critical path.
+            const double r = (rotate[b] * re[b] - rotate[bins + b] * im[b]) +
+                             (x_new - leave[b] * x_old);
+            const double j = (rotate[b] * im[b] + rotate[bins + b] * re[b]) -
+                             leave[bins + b] * x_old;
+            re[b] = r;
+            im[b] = j;
+        }
+    }
+}
+
+#ifdef BTCCW_GOERTZEL_X86
+
+namespace {
+
+// Gather offsets are 32-bit; beyond this stride the vector paths defer to
+// the scalar reference.
+constexpr std::size_t kMaxGatherStride = INT32_MAX / 16;
+
+// ---------------------------------------------------------------------------
+// SSE2: 2 blocks per register, 2 registers in flight
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+void block_powers_sse2(const float* pcm, std::size_t count,
+                       std::size_t block_size, std::size_t stride,
+                       double coeff, double* out) {
+    const __m128d c = _mm_set1_pd(coeff);
+    std::size_t b = 0;
+
+    for (; b + 4 <= count; b += 4) {
+        const float* p0 = pcm + b * stride;
+        const float* p1 = p0 + stride;
+        const float* p2 = p1 + stride;
+        const float* p3 = p2 + stride;
+        __m128d a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd();
+        __m128d b1 = _mm_setzero_pd(), b2 = _mm_setzero_pd();
+
+        for (std::size_t i = 0; i < block_size; ++i) {
+            __m128d xa = _mm_set_pd(static_cast<double>(p1[i]), static_cast<double>(p0[i]));
+            __m128d xb = _mm_set_pd(static_cast<double>(p3[i]), static_cast<double>(p2[i]));
+            __m128d sa = _mm_sub_pd(_mm_add_pd(xa, _mm_mul_pd(c, a1)), a2);
+            __m128d sb = _mm_sub_pd(_mm_add_pd(xb, _mm_mul_pd(c, b1)), b2);
+            a2 = a1; a1 = sa;
+            b2 = b1; b1 = sb;
+        }
+
+        __m128d pa = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(a1, a1), _mm_mul_pd(a2, a2)),
+                                _mm_mul_pd(_mm_mul_pd(c, a1), a2));
+        __m128d pb = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(b1, b1), _mm_mul_pd(b2, b2)),
+                                _mm_mul_pd(_mm_mul_pd(c, b1), b2));
+        _mm_storeu_pd(out + b, pa);
+        _mm_storeu_pd(out + b + 2, pb);
+    }
+
+    GoertzelKernel::block_powers_scalar(pcm + b * stride, count - b, block_size,
+                                        stride, coeff, out + b);
+}
+
+__attribute__((target("sse2")))
+void bin_powers_sse2(const float* samples, std::size_t block_size,
+                     const double* coeffs, std::size_t bins,
+                     double* state, double* out) {
+    double* p1 = state;
+    double* p2 = state + bins;
+    std::fill(state, state + 2 * bins, 0.0);
+    const std::size_t vec_bins = bins & ~std::size_t{1};
+
+    for (std::size_t i = 0; i < block_size; ++i) {
+        const double  xs = static_cast<double>(samples[i]);
+        const __m128d x  = _mm_set1_pd(xs);
+        std::size_t b = 0;
+        for (; b < vec_bins; b += 2) {
+            __m128d s1 = _mm_loadu_pd(p1 + b);
+            __m128d s0 = _mm_sub_pd(
+                _mm_add_pd(x, _mm_mul_pd(_mm_loadu_pd(coeffs + b), s1)),
+                _mm_loadu_pd(p2 + b));
+            _mm_storeu_pd(p2 + b, s1);
+            _mm_storeu_pd(p1 + b, s0);
+        }
+        for (; b < bins; ++b) {
+            double s0 = xs + coeffs[b] * p1[b] - p2[b];
+            p2[b] = p1[b];
+            p1[b] = s0;
+        }
+    }
+
+    for (std::size_t b = 0; b < bins; ++b) {
+        out[b] = p1[b] * p1[b] + p2[b] * p2[b] - coeffs[b] * p1[b] * p2[b];
+    }
+}
+
+__attribute__((target("sse2")))
+void slide_bins_sse2(const float* oldest, const float* newest, std::size_t count,
+                    const double* rotate, const double* leave, std::size_t bins,
+                    double* bin) {
+    const std::size_t vec_bins = bins & ~std::size_t{1};
+    double* re = bin;
+    double* im = bin + bins;
+
+    // 2 bins per register, 2 registers in flight; Y stays in registers
+    // across the samples.
+    std::size_t b = 0;
+    for (; b + 4 <= vec_bins; b += 4) {
+        const __m128d rr0 = _mm_loadu_pd(rotate + b);
+        const __m128d rr1 = _mm_loadu_pd(rotate + b + 2);
+        const __m128d ri0 = _mm_loadu_pd(rotate + bins + b);
+        const __m128d ri1 = _mm_loadu_pd(rotate + bins + b + 2);
+        const __m128d lr0 = _mm_loadu_pd(leave + b);
+        const __m128d lr1 = _mm_loadu_pd(leave + b + 2);
+        const __m128d li0 = _mm_loadu_pd(leave + bins + b);
+        const __m128d li1 = _mm_loadu_pd(leave + bins + b + 2);
+        __m128d yr0 = _mm_loadu_pd(re + b), yr1 = _mm_loadu_pd(re + b + 2);
+        __m128d yi0 = _mm_loadu_pd(im + b), yi1 = _mm_loadu_pd(im + b + 2);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m128d xo = _mm_set1_pd(static_cast<double>(oldest[t]));
+            const __m128d xn = _mm_set1_pd(static_cast<double>(newest[t]));
+            const __m128d zr0 = _mm_sub_pd(_mm_mul_pd(rr0, yr0), _mm_mul_pd(ri0, yi0));
+            const __m128d zi0 = _mm_add_pd(_mm_mul_pd(rr0, yi0), _mm_mul_pd(ri0, yr0));
+            yr0 = _mm_add_pd(zr0, _mm_sub_pd(xn, _mm_mul_pd(lr0, xo)));
+            yi0 = _mm_sub_pd(zi0, _mm_mul_pd(li0, xo));
+            const __m128d zr1 = _mm_sub_pd(_mm_mul_pd(rr1, yr1), _mm_mul_pd(ri1, yi1));
+            const __m128d zi1 = _mm_add_pd(_mm_mul_pd(rr1, yi1), _mm_mul_pd(ri1, yr1));
+            yr1 = _mm_add_pd(zr1, _mm_sub_pd(xn, _mm_mul_pd(lr1, xo)));
+            yi1 = _mm_sub_pd(zi1, _mm_mul_pd(li1, xo));
+        }
+        _mm_storeu_pd(re + b, yr0); _mm_storeu_pd(re + b + 2, yr1);
+        _mm_storeu_pd(im + b, yi0); _mm_storeu_pd(im + b + 2, yi1);
+    }
+    for (; b < vec_bins; b += 2) {
+        const __m128d rr = _mm_loadu_pd(rotate + b);
+        const __m128d ri = _mm_loadu_pd(rotate + bins + b);
+        const __m128d lr = _mm_loadu_pd(leave + b);
+        const __m128d li = _mm_loadu_pd(leave + bins + b);
+        __m128d yr = _mm_loadu_pd(re + b);
+        __m128d yi = _mm_loadu_pd(im + b);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m128d xo = _mm_set1_pd(static_cast<double>(oldest[t]));
+            const __m128d xn = _mm_set1_pd(static_cast<double>(newest[t]));
+            const __m128d zr = _mm_sub_pd(_mm_mul_pd(rr, yr), _mm_mul_pd(ri, yi));
+            const __m128d zi = _mm_add_pd(_mm_mul_pd(rr, yi), _mm_mul_pd(ri, yr));
+            yr = _mm_add_pd(zr, _mm_sub_pd(xn, _mm_mul_pd(lr, xo)));
+            yi = _mm_sub_pd(zi, _mm_mul_pd(li, xo));
+        }
+        _mm_storeu_pd(re + b, yr);
+        _mm_storeu_pd(im + b, yi);
+    }
+    for (; b < bins; ++b) {
+        double yr = re[b];
+        double yi = im[b];
+        for (std::size_t t = 0; t < count; ++t) {
+            const double x_old = static_cast<double>(oldest[t]);
+            const double x_new = static_cast<double>(newest[t]);
+            const double r = (rotate[b] * yr - rotate[bins + b] * yi) +
+                             (x_new - leave[b] * x_old);
+            const double j = (rotate[b] * yi + rotate[bins + b] * yr) -
+                             leave[bins + b] * x_old;
+            yr = r;
+            yi = j;
+        }
+        re[b] = yr;
+        im[b] = yi;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 4 blocks per register, 2 registers in flight
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+void block_powers_avx2(const float* pcm, std::size_t count,
+                       std::size_t block_size, std::size_t stride,
+                       double coeff, double* out) {
+    if (stride > kMaxGatherStride) {
+        GoertzelKernel::block_powers_scalar(pcm, count, block_size, stride, coeff, out);
+        return;
+    }
+
+    const __m256d c   = _mm256_set1_pd(coeff);
+    const auto    s   = static_cast<int>(stride);
+    const __m128i idx = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+    std::size_t b = 0;
+
+    for (; b + 8 <= count; b += 8) {
+        const float* pa = pcm + b * stride;
+        const float* pb = pa + 4 * stride;
+        __m256d a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd();
+        __m256d b1 = _mm256_setzero_pd(), b2 = _mm256_setzero_pd();
+
+        for (std::size_t i = 0; i < block_size; ++i) {
+            __m256d xa = _mm256_cvtps_pd(_mm_i32gather_ps(pa + i, idx, 4));
+            __m256d xb = _mm256_cvtps_pd(_mm_i32gather_ps(pb + i, idx, 4));
+            __m256d sa = _mm256_sub_pd(_mm256_add_pd(xa, _mm256_mul_pd(c, a1)), a2);
+            __m256d sb = _mm256_sub_pd(_mm256_add_pd(xb, _mm256_mul_pd(c, b1)), b2);
+            a2 = a1; a1 = sa;
+            b2 = b1; b1 = sb;
+        }
+
+        __m256d qa = _mm256_sub_pd(
+            _mm256_add_pd(_mm256_mul_pd(a1, a1), _mm256_mul_pd(a2, a2)),
+            _mm256_mul_pd(_mm256_mul_pd(c, a1), a2));
+        __m256d qb = _mm256_sub_pd(
+            _mm256_add_pd(_mm256_mul_pd(b1, b1), _mm256_mul_pd(b2, b2)),
+            _mm256_mul_pd(_mm256_mul_pd(c, b1), b2));
+        _mm256_storeu_pd(out + b, qa);
+        _mm256_storeu_pd(out + b + 4, qb);
+    }
+
+    block_powers_sse2(pcm + b * stride, count - b, block_size, stride, coeff, out + b);
+}
+
+__attribute__((target("avx2")))
+void bin_powers_avx2(const float* samples, std::size_t block_size,
+                     const double* coeffs, std::size_t bins,
+                     double* state, double* out) {
+    double* p1 = state;
+    double* p2 = state + bins;
+    std::fill(state, state + 2 * bins, 0.0);
+    const std::size_t vec_bins = bins & ~std::size_t{3};
+
+    for (std::size_t i = 0; i < block_size; ++i) {
+        const double  xs = static_cast<double>(samples[i]);
+        const __m256d x  = _mm256_set1_pd(xs);
+        std::size_t b = 0;
+        for (; b < vec_bins; b += 4) {
+            __m256d s1 = _mm256_loadu_pd(p1 + b);
+            __m256d s0 = _mm256_sub_pd(
+                _mm256_add_pd(x, _mm256_mul_pd(_mm256_loadu_pd(coeffs + b), s1)),
+                _mm256_loadu_pd(p2 + b));
+            _mm256_storeu_pd(p2 + b, s1);
+            _mm256_storeu_pd(p1 + b, s0);
+        }
+        for (; b < bins; ++b) {
+            double s0 = xs + coeffs[b] * p1[b] - p2[b];
+            p2[b] = p1[b];
+            p1[b] = s0;
+        }
+    }
+
+    for (std::size_t b = 0; b < bins; ++b) {
+        out[b] = p1[b] * p1[b] + p2[b] * p2[b] - coeffs[b] * p1[b] * p2[b];
+    }
+}
+
+__attribute__((target("avx2")))
+void slide_bins_avx2(const float* oldest, const float* newest, std::size_t count,
+                    const double* rotate, const double* leave, std::size_t bins,
+                    double* bin) {
+    const std::size_t vec_bins = bins & ~std::size_t{3};
+    double* re = bin;
+    double* im = bin + bins;
+
+    // 4 bins per register, 2 registers in flight; Y stays in registers
+    // across the samples.
+    std::size_t b = 0;
+    for (; b + 8 <= vec_bins; b += 8) {
+        const __m256d rr0 = _mm256_loadu_pd(rotate + b);
+        const __m256d rr1 = _mm256_loadu_pd(rotate + b + 4);
+        const __m256d ri0 = _mm256_loadu_pd(rotate + bins + b);
+        const __m256d ri1 = _mm256_loadu_pd(rotate + bins + b + 4);
+        const __m256d lr0 = _mm256_loadu_pd(leave + b);
+        const __m256d lr1 = _mm256_loadu_pd(leave + b + 4);
+        const __m256d li0 = _mm256_loadu_pd(leave + bins + b);
+        const __m256d li1 = _mm256_loadu_pd(leave + bins + b + 4);
+        __m256d yr0 = _mm256_loadu_pd(re + b), yr1 = _mm256_loadu_pd(re + b + 4);
+        __m256d yi0 = _mm256_loadu_pd(im + b), yi1 = _mm256_loadu_pd(im + b + 4);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m256d xo = _mm256_set1_pd(static_cast<double>(oldest[t]));
+            const __m256d xn = _mm256_set1_pd(static_cast<double>(newest[t]));
+            const __m256d zr0 = _mm256_sub_pd(_mm256_mul_pd(rr0, yr0), _mm256_mul_pd(ri0, yi0));
+            const __m256d zi0 = _mm256_add_pd(_mm256_mul_pd(rr0, yi0), _mm256_mul_pd(ri0, yr0));
+            yr0 = _mm256_add_pd(zr0, _mm256_sub_pd(xn, _mm256_mul_pd(lr0, xo)));
+            yi0 = _mm256_sub_pd(zi0, _mm256_mul_pd(li0, xo));
+            const __m256d zr1 = _mm256_sub_pd(_mm256_mul_pd(rr1, yr1), _mm256_mul_pd(ri1, yi1));
+            const __m256d zi1 = _mm256_add_pd(_mm256_mul_pd(rr1, yi1), _mm256_mul_pd(ri1, yr1));
+            yr1 = _mm256_add_pd(zr1, _mm256_sub_pd(xn, _mm256_mul_pd(lr1, xo)));
+            yi1 = _mm256_sub_pd(zi1, _mm256_mul_pd(li1, xo));
+        }
+        _mm256_storeu_pd(re + b, yr0); _mm256_storeu_pd(re + b + 4, yr1);
+        _mm256_storeu_pd(im + b, yi0); _mm256_storeu_pd(im + b + 4, yi1);
+    }
+    for (; b < vec_bins; b += 4) {
+        const __m256d rr = _mm256_loadu_pd(rotate + b);
+        const __m256d ri = _mm256_loadu_pd(rotate + bins + b);
+        const __m256d lr = _mm256_loadu_pd(leave + b);
+        const __m256d li = _mm256_loadu_pd(leave + bins + b);
+        __m256d yr = _mm256_loadu_pd(re + b);
+        __m256d yi = _mm256_loadu_pd(im + b);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m256d xo = _mm256_set1_pd(static_cast<double>(oldest[t]));
+            const __m256d xn = _mm256_set1_pd(static_cast<double>(newest[t]));
+            const __m256d zr = _mm256_sub_pd(_mm256_mul_pd(rr, yr), _mm256_mul_pd(ri, yi));
+            const __m256d zi = _mm256_add_pd(_mm256_mul_pd(rr, yi), _mm256_mul_pd(ri, yr));
+            yr = _mm256_add_pd(zr, _mm256_sub_pd(xn, _mm256_mul_pd(lr, xo)));
+            yi = _mm256_sub_pd(zi, _mm256_mul_pd(li, xo));
+        }
+        _mm256_storeu_pd(re + b, yr);
+        _mm256_storeu_pd(im + b, yi);
+    }
+    for (; b < bins; ++b) {
+        double yr = re[b];
+        double yi = im[b];
+        for (std::size_t t = 0; t < count; ++t) {
+            const double x_old = static_cast<double>(oldest[t]);
+            const double x_new = static_cast<double>(newest[t]);
+            const double r = (rotate[b] * yr - rotate[bins + b] * yi) +
+                             (x_new - leave[b] * x_old);
+            const double j = (rotate[b] * yi + rotate[bins + b] * yr) -
+                             leave[bins + b] * x_old;
+            yr = r;
+            yi = j;
+        }
+        re[b] = yr;
+        im[b] = yi;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512: 8 blocks per register, 2 registers in flight
+// ---------------------------------------------------------------------------
+
+/// Eight floats to doubles. _mm512_cvtps_pd() merges into an undefined
+/// register, which GCC 12 reports as maybe-uninitialized; a full mask with
+/// zeroing converts the same lanes.
+__attribute__((target("avx512f")))
+inline __m512d widen(__m256 x) {
+    return _mm512_maskz_cvtps_pd(0xFF, x);
+}
+
+__attribute__((target("avx512f")))
+void block_powers_avx512(const float* pcm, std::size_t count,
+                         std::size_t block_size, std::size_t stride,
+                         double coeff, double* out) {
+    if (stride > kMaxGatherStride) {
+        GoertzelKernel::block_powers_scalar(pcm, count, block_size, stride, coeff, out);
+        return;
+    }
+
+    const __m512d c   = _mm512_set1_pd(coeff);
+    const auto    s   = static_cast<int>(stride);
+    const __m256i idx = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+    std::size_t b = 0;
+
+    for (; b + 16 <= count; b += 16) {
+        const float* pa = pcm + b * stride;
+        const float* pb = pa + 8 * stride;
+        __m512d a1 = _mm512_setzero_pd(), a2 = _mm512_setzero_pd();
+        __m512d b1 = _mm512_setzero_pd(), b2 = _mm512_setzero_pd();
+
+        for (std::size_t i = 0; i < block_size; ++i) {
+            __m512d xa = widen(_mm256_i32gather_ps(pa + i, idx, 4));
+            __m512d xb = widen(_mm256_i32gather_ps(pb + i, idx, 4));
+            __m512d sa = _mm512_sub_pd(_mm512_add_pd(xa, _mm512_mul_pd(c, a1)), a2);
+            __m512d sb = _mm512_sub_pd(_mm512_add_pd(xb, _mm512_mul_pd(c, b1)), b2);
+            a2 = a1; a1 = sa;
+            b2 = b1; b1 = sb;
+        }
+
+        __m512d qa = _mm512_sub_pd(
+            _mm512_add_pd(_mm512_mul_pd(a1, a1), _mm512_mul_pd(a2, a2)),
+            _mm512_mul_pd(_mm512_mul_pd(c, a1), a2));
+        __m512d qb = _mm512_sub_pd(
+            _mm512_add_pd(_mm512_mul_pd(b1, b1), _mm512_mul_pd(b2, b2)),
+            _mm512_mul_pd(_mm512_mul_pd(c, b1), b2));
+        _mm512_storeu_pd(out + b, qa);
+        _mm512_storeu_pd(out + b + 8, qb);
+    }
+
+    block_powers_avx2(pcm + b * stride, count - b, block_size, stride, coeff, out + b);
+}
+
+__attribute__((target("avx512f")))
+void bin_powers_avx512(const float* samples, std::size_t block_size,
+                       const double* coeffs, std::size_t bins,
+                       double* state, double* out) {
+    double* p1 = state;
+    double* p2 = state + bins;
+    std::fill(state, state + 2 * bins, 0.0);
+    const std::size_t vec_bins = bins & ~std::size_t{7};
+
+    for (std::size_t i = 0; i < block_size; ++i) {
+        const double  xs = static_cast<double>(samples[i]);
+        const __m512d x  = _mm512_set1_pd(xs);
+        std::size_t b = 0;
+        for (; b < vec_bins; b += 8) {
+            __m512d s1 = _mm512_loadu_pd(p1 + b);
+            __m512d s0 = _mm512_sub_pd(
+                _mm512_add_pd(x, _mm512_mul_pd(_mm512_loadu_pd(coeffs + b), s1)),
+                _mm512_loadu_pd(p2 + b));
+            _mm512_storeu_pd(p2 + b, s1);
+            _mm512_storeu_pd(p1 + b, s0);
+        }
+        for (; b < bins; ++b) {
+            double s0 = xs + coeffs[b] * p1[b] - p2[b];
+            p2[b] = p1[b];
+            p1[b] = s0;
+        }
+    }
+
+    for (std::size_t b = 0; b < bins; ++b) {
+        out[b] = p1[b] * p1[b] + p2[b] * p2[b] - coeffs[b] * p1[b] * p2[b];
+    }
+}
+
+__attribute__((target("avx512f")))
+void slide_bins_avx512(const float* oldest, const float* newest, std::size_t count,
+                      const double* rotate, const double* leave, std::size_t bins,
+                      double* bin) {
+    const std::size_t vec_bins = bins & ~std::size_t{7};
+    double* re = bin;
+    double* im = bin + bins;
+
+    // 8 bins per register, 2 registers in flight; Y stays in registers
+    // across the samples.
+    std::size_t b = 0;
+    for (; b + 16 <= vec_bins; b += 16) {
+        const __m512d rr0 = _mm512_loadu_pd(rotate + b);
+        const __m512d rr1 = _mm512_loadu_pd(rotate + b + 8);
+        const __m512d ri0 = _mm512_loadu_pd(rotate + bins + b);
+        const __m512d ri1 = _mm512_loadu_pd(rotate + bins + b + 8);
+        const __m512d lr0 = _mm512_loadu_pd(leave + b);
+        const __m512d lr1 = _mm512_loadu_pd(leave + b + 8);
+        const __m512d li0 = _mm512_loadu_pd(leave + bins + b);
+        const __m512d li1 = _mm512_loadu_pd(leave + bins + b + 8);
+        __m512d yr0 = _mm512_loadu_pd(re + b), yr1 = _mm512_loadu_pd(re + b + 8);
+        __m512d yi0 = _mm512_loadu_pd(im + b), yi1 = _mm512_loadu_pd(im + b + 8);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m512d xo = _mm512_set1_pd(static_cast<double>(oldest[t]));
+            const __m512d xn = _mm512_set1_pd(static_cast<double>(newest[t]));
+            const __m512d zr0 = _mm512_sub_pd(_mm512_mul_pd(rr0, yr0), _mm512_mul_pd(ri0, yi0));
+            const __m512d zi0 = _mm512_add_pd(_mm512_mul_pd(rr0, yi0), _mm512_mul_pd(ri0, yr0));
+            yr0 = _mm512_add_pd(zr0, _mm512_sub_pd(xn, _mm512_mul_pd(lr0, xo)));
+            yi0 = _mm512_sub_pd(zi0, _mm512_mul_pd(li0, xo));
+            const __m512d zr1 = _mm512_sub_pd(_mm512_mul_pd(rr1, yr1), _mm512_mul_pd(ri1, yi1));
+            const __m512d zi1 = _mm512_add_pd(_mm512_mul_pd(rr1, yi1), _mm512_mul_pd(ri1, yr1));
+            yr1 = _mm512_add_pd(zr1, _mm512_sub_pd(xn, _mm512_mul_pd(lr1, xo)));
+            yi1 = _mm512_sub_pd(zi1, _mm512_mul_pd(li1, xo));
+        }
+        _mm512_storeu_pd(re + b, yr0); _mm512_storeu_pd(re + b + 8, yr1);
+        _mm512_storeu_pd(im + b, yi0); _mm512_storeu_pd(im + b + 8, yi1);
+    }
+    for (; b < vec_bins; b += 8) {
+        const __m512d rr = _mm512_loadu_pd(rotate + b);
+        const __m512d ri = _mm512_loadu_pd(rotate + bins + b);
+        const __m512d lr = _mm512_loadu_pd(leave + b);
+        const __m512d li = _mm512_loadu_pd(leave + bins + b);
+        __m512d yr = _mm512_loadu_pd(re + b);
+        __m512d yi = _mm512_loadu_pd(im + b);
+        for (std::size_t t = 0; t < count; ++t) {
+            const __m512d xo = _mm512_set1_pd(static_cast<double>(oldest[t]));
+            const __m512d xn = _mm512_set1_pd(static_cast<double>(newest[t]));
+            const __m512d zr = _mm512_sub_pd(_mm512_mul_pd(rr, yr), _mm512_mul_pd(ri, yi));
+            const __m512d zi = _mm512_add_pd(_mm512_mul_pd(rr, yi), _mm512_mul_pd(ri, yr));
+            yr = _mm512_add_pd(zr, _mm512_sub_pd(xn, _mm512_mul_pd(lr, xo)));
+            yi = _mm512_sub_pd(zi, _mm512_mul_pd(li, xo));
+        }
+        _mm512_storeu_pd(re + b, yr);
+        _mm512_storeu_pd(im + b, yi);
+    }
+    for (; b < bins; ++b) {
+        double yr = re[b];
+        double yi = im[b];
+        for (std::size_t t = 0; t < count; ++t) {
+            const double x_old = static_cast<double>(oldest[t]);
+            const double x_new = static_cast<double>(newest[t]);
+            const double r = (rotate[b] * yr - rotate[bins + b] * yi) +
+                             (x_new - leave[b] * x_old);
+            const double j = (rotate[b] * yi + rotate[bins + b] * yr) -
+                             leave[bins + b] * x_old;
+            yr = r;
+            yi = j;
+        }
+        re[b] = yr;
+        im[b] = yi;
+    }
+}
+
+} // namespace
+
+#endif // BTCCW_GOERTZEL_X86
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+namespace {
+
+using BlockPowersFn = void (*)(const float*, std::size_t, std::size_t,
+                               std::size_t, double, double*);
+using BinPowersFn   = void (*)(const float*, std::size_t, const double*,
+                               std::size_t, double*, double*);
+using SlideBinsFn   = void (*)(const float*, const float*, std::size_t,
+                               const double*, const double*, std::size_t, double*);
+
+struct KernelImpl {
+    const char*   name;
+    BlockPowersFn block;
+    BinPowersFn   bin;
+    SlideBinsFn   slide;
+};
+
+KernelImpl select_impl() {
+#ifdef BTCCW_GOERTZEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return {"avx512", &block_powers_avx512, &bin_powers_avx512, &slide_bins_avx512};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", &block_powers_avx2, &bin_powers_avx2, &slide_bins_avx2};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {"sse2", &block_powers_sse2, &bin_powers_sse2, &slide_bins_sse2};
+    }
+#endif
+    return {"scalar", &GoertzelKernel::block_powers_scalar,
+            &GoertzelKernel::bin_powers_scalar, &GoertzelKernel::slide_bins_scalar};
+}
+
+const KernelImpl& impl() {
+    static const KernelImpl selected = select_impl();
+    return selected;
+}
+
+} // namespace
+
+void GoertzelKernel::block_powers(const float* pcm, std::size_t count,
+                                  std::size_t block_size, std::size_t stride,
+                                  double coeff, double* out) {
+    impl().block(pcm, count, block_size, stride, coeff, out);
+}
+
+void GoertzelKernel::bin_powers(const float* samples, std::size_t block_size,
+                                const double* coeffs, std::size_t bins,
+                                double* state, double* out) {
+    impl().bin(samples, block_size, coeffs, bins, state, out);
+}
+
+void GoertzelKernel::slide_bins(const float* oldest, const float* newest,
+                                std::size_t count, const double* rotate,
+                                const double* leave, std::size_t bins, double* bin) {
+    impl().slide(oldest, newest, count, rotate, leave, bins, bin);
+}
+
+const char* GoertzelKernel::name() { return impl().name; }
+
+} // namespace btccw::node
@@ -0,0 +1,270 @@
+#include "json.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace btccw::node {
+
+// ---------------------------------------------------------------------------
+// JsonWriter
+// ---------------------------------------------------------------------------
+
+void JsonWriter::separate() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (first_.empty()) return;
+    if (!first_.back()) out_ += ',';
+    first_.back() = false;
+}
+
+JsonWriter& JsonWriter::open(char bracket) {
+    separate();
+    out_ += bracket;
+    first_.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::close(char bracket) {
+    out_ += bracket;
+    if (!first_.empty()) first_.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    value(name);
+    out_ += ':';
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    out_ += '"';
+    // Copy runs that need no escaping in one append.
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out_.append(text, run, i - run);
+        switch (c) {
+            case '"':  out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\n': out_ += "\\n";  break;
+            case '\r': out_ += "\\r";  break;
+            case '\t': out_ += "\\t";  break;
+            default: {
+                char esc[8];
+                std::snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out_ += esc;
+            }
+        }
+        run = i + 1;
+    }
+    out_.append(text, run, std::string_view::npos);
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    out_ += std::to_string(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out_ += flag ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_ += "null";
+    return *this;
+}
+
+// ---------------------------------------------------------------------------
+// JsonValue
+// ---------------------------------------------------------------------------
+
+/// Recursive-descent parser over one document.
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : s_(text) {}
+
+    bool document(JsonValue& out) {
+        return value(out, 0) && (skip_ws(), pos_ == s_.size());
+    }
+
+private:
+    std::string_view s_;
+    std::size_t      pos_ = 0;
+
+    void skip_ws() {
+        while (pos_ < s_.size() &&
+               (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool literal(std::string_view word) {
+        if (s_.compare(pos_, word.size(), word) != 0) return false;
+        pos_ += word.size();
+        return true;
+    }
+
+    bool value(JsonValue& out, int depth) {
+        if (depth > JsonValue::kMaxDepth) return false;
+        skip_ws();
+        if (pos_ >= s_.size()) return false;
+        switch (s_[pos_]) {
+            case '{': return object(out, depth);
+            case '[': return array(out, depth);
+            case '"': out.type_ = JsonValue::Type::String; return string(out.text_);
+            case 't': out.type_ = JsonValue::Type::Bool; out.flag_ = true;  return literal("true");
+            case 'f': out.type_ = JsonValue::Type::Bool; out.flag_ = false; return literal("false");
+            case 'n': out.type_ = JsonValue::Type::Null; return literal("null");
+            default:  return number(out);
+        }
+    }
+
+    bool object(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Object;
+        ++pos_;   // '{'
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == '}') { ++pos_; return true; }
+        for (;;) {
+            skip_ws();
+            std::string name;
+            if (pos_ >= s_.size() || s_[pos_] != '"' || !string(name)) return false;
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+            out.keys_.push_back(std::move(name));
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) return false;
+            skip_ws();
+            if (pos_ >= s_.size()) return false;
+            if (s_[pos_] == ',') { ++pos_; continue; }
+            if (s_[pos_] == '}') { ++pos_; return true; }
+            return false;
+        }
+    }
+
+    bool array(JsonValue& out, int depth) {
+        out.type_ = JsonValue::Type::Array;
+        ++pos_;   // '['
+        skip_ws();
+        if (pos_ < s_.size() && s_[pos_] == ']') { ++pos_; return true; }
+        for (;;) {
+            out.items_.emplace_back();
+            if (!value(out.items_.back(), depth + 1)) return false;
+            skip_ws();
+            if (pos_ >= s_.size()) return false;
+            if (s_[pos_] == ',') { ++pos_; continue; }
+            if (s_[pos_] == ']') { ++pos_; return true; }
+            return false;
+        }
+    }
+
+    bool number(JsonValue& out) {
+        const std::size_t start = pos_;
+        if (pos_ < s_.size() && s_[pos_] == '-') ++pos_;
+        while (pos_ < s_.size() &&
+               ((s_[pos_] >= '0' && s_[pos_] <= '9') || s_[pos_] == '.' ||
+                s_[pos_] == 'e' || s_[pos_] == 'E' || s_[pos_] == '+' || s_[pos_] == '-')) {
+            ++pos_;
+        }
+        if (pos_ == start) return false;
+        const std::string digits(s_.substr(start, pos_ - start));
+        char* end = nullptr;
+        out.type_   = JsonValue::Type::Number;
+        out.number_ = std::strtod(digits.c_str(), &end);
+        return end == digits.c_str() + digits.size();
+    }
+
+    static void append_utf8(std::string& out, unsigned long cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool hex4(unsigned long& cp) {
+        if (pos_ + 4 > s_.size()) return false;
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = s_[pos_++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9')      cp |= static_cast<unsigned long>(c - '0');
+            else if (c >= 'a' && c <= 'f') cp |= static_cast<unsigned long>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') cp |= static_cast<unsigned long>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool string(std::string& out) {
+        ++pos_;   // opening quote
+        for (;;) {
+            // Plain run up to the next quote or escape in one append.
+            const std::size_t run = pos_;
+            while (pos_ < s_.size() && s_[pos_] != '"' && s_[pos_] != '\\') ++pos_;
+            out.append(s_, run, pos_ - run);
+            if (pos_ >= s_.size()) return false;
+            if (s_[pos_++] == '"') return true;
+
+            if (pos_ >= s_.size()) return false;
+            const char esc = s_[pos_++];
+            switch (esc) {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    unsigned long cp = 0;
+                    if (!hex4(cp)) return false;
+                    // A high surrogate pairs with the \u escape after it.
+                    if (cp >= 0xD800 && cp < 0xDC00 && literal("\\u")) {
+                        unsigned long low = 0;
+                        if (!hex4(low) || low < 0xDC00 || low >= 0xE000) return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+    }
+};
+
+bool JsonValue::parse(std::string_view text, JsonValue& out) {
+    out = JsonValue{};
+    return JsonParser(text).document(out);
+}
+
+const JsonValue* JsonValue::find(std::string_view name) const noexcept {
+    for (std::size_t i = 0; i < keys_.size(); ++i) {
+        if (keys_[i] == name) return &items_[i];
+    }
+    return nullptr;
+}
+
+} // namespace btccw::node
@@ -1,20 +1,42 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <btccw/btccw.hpp>
 
+#include "daemon.hpp"
+#include "file_decoder.hpp"
 #include "node_engine.hpp"
 
 static void print_usage() {
     std::puts(
         "btc-cw-node v1.0.0\n"
         "Usage:\n"
-        "  btc-cw-node tx <raw_hex>      Validate, encode, and transmit a TX via audio\n"
+        "  btc-cw-node tx <raw_hex> [fec_parity [fragment_chars [i,j,...]]]\n"
+        "                                 Validate, encode, and transmit a TX via audio\n"
+        "                                 (optionally only fragments i, j, ...)\n"
         "  btc-cw-node listen <seconds>   Capture audio from the mic\n"
-        "  btc-cw-node broadcast <hex>    Broadcast a raw TX to the Bitcoin network\n"
+        "  btc-cw-node scan <seconds> [lo_hz hi_hz bins]\n"
+        "                                 Capture and decode every station in a band\n"
+        "  btc-cw-node broadcast <hex> [hex...]\n"
+        "                                 Broadcast raw TXs to the Bitcoin network\n"
+        "  btc-cw-node daemon [queue_depth]\n"
+        "                                 Listen, decode and broadcast until SIGTERM\n"
+        "  btc-cw-node decode-file [options] <file|dir> [...]\n"
+        "                                 Decode WAV / raw PCM recordings in parallel\n"
+        "                                 --threads N, --chunk S (seconds per chunk),\n"
+        "                                 --max-frame S (longest frame; 0 = derived)\n"
         "  btc-cw-node devices            List available audio devices\n"
-        "  btc-cw-node loopback <hex>     Full acoustic loopback test\n"
+        "  btc-cw-node loopback <hex> [fec_parity [fragment_chars]]\n"
+        "                                 Full acoustic loopback test\n"
     );
 }
 
@@ -22,8 +44,9 @@ static void print_usage() {
 // Commands
 // ---------------------------------------------------------------------------
 
-static int cmd_tx(btccw::node::NodeEngine& engine, const char* hex) {
-    auto timing = engine.encode_tx(hex);
+static int cmd_tx(btccw::node::NodeEngine& engine, const char* hex,
+                  const std::vector<std::size_t>& fragments) {
+    auto timing = engine.encode_tx(hex, fragments);
     if (timing.empty()) {
         std::fprintf(stderr, "error: invalid or unsigned transaction\n");
         return 1;
@@ -31,7 +54,18 @@ static int cmd_tx(btccw::node::NodeEngine& engine, const char* hex) {
 
     std::printf("[tx] encoded %zu morse timing units\n", timing.size());
 
-    if (!engine.play(timing)) {
+    // One progress line, rewritten in place each time the percentage moves.
+    int last_percent = -1;
+    bool ok = engine.play(timing, [&](const btccw::node::TransmitProgress& p) {
+        int percent = p.units_total ? static_cast<int>(100 * p.units_sent / p.units_total) : 100;
+        if (percent == last_percent) return;
+        last_percent = percent;
+        std::printf("\r[tx] %3d%%  %zu/%zu units, %.1f s remaining ",
+                    percent, p.units_sent, p.units_total, p.remaining_s);
+        std::fflush(stdout);
+    });
+    std::putchar('\n');
+    if (!ok) {
         std::fprintf(stderr, "error: audio playback failed\n");
         return 1;
     }
@@ -53,23 +87,93 @@ static const char* stage_name(btccw::node::DecodeStage stage) {
     return "unknown";
 }
 
+static void print_fragment(const btccw::node::NodeEngine& engine, const char* tag,
+                           const btccw::node::DecodeResult& result) {
+    const auto& fragment = result.fragment;
+    std::string missing;
+    for (std::size_t i : engine.reassembler().missing(fragment.tx_id)) {
+        missing += (missing.empty() ? "" : ",") + std::to_string(i);
+    }
+    std::printf("[%s] TX %s: fragment %zu of %zu%s%s\n", tag, fragment.tx_id.c_str(),
+                fragment.index, fragment.count,
+                missing.empty() ? "" : ", missing ", missing.c_str());
+    if (result.error.find("; ") != std::string::npos) {
+        std::fprintf(stderr, "[%s] %s\n", tag, result.error.c_str());
+    }
+}
+
+/// "1,4,7" -> {1, 4, 7}
+static std::vector<std::size_t> parse_indices(const char* list) {
+    std::vector<std::size_t> out;
+    for (const char* p = list; *p;) {
+        char* end = nullptr;
+        unsigned long value = std::strtoul(p, &end, 10);
+        if (end == p) break;
+        out.push_back(static_cast<std::size_t>(value));
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return out;
+}
+
 static int cmd_listen(btccw::node::NodeEngine& engine, double seconds) {
     std::printf("[listen] capturing %.1f seconds of audio...\n", seconds);
+
+    int decoded = 0;
+    std::size_t frames = engine.listen_stream(
+        seconds, [&](const btccw::node::DecodeResult& result) {
+            if (result.success) {
+                ++decoded;
+                std::printf("[listen] decoded TX (%.0f WPM): %s\n",
+                            result.wpm, result.hex_string.c_str());
+            } else if (result.fragment.count > 0) {
+                print_fragment(engine, "listen", result);
+            } else {
+                std::fprintf(stderr, "[listen] frame failed at stage '%s': %s\n",
+                             stage_name(result.stage_reached), result.error.c_str());
+            }
+            std::fflush(stdout);
+        });
+
+    if (frames == 0) {
+        std::fprintf(stderr, "[listen] no frame recovered\n");
+    }
+
+    auto stats = engine.capture_stats();
+    if (stats.capacity > 0) {
+        std::printf("[listen] ring high water %zu/%zu frames, %llu overruns "
+                    "(%llu frames dropped), %llu stalls\n",
+                    stats.high_water, stats.capacity,
+                    static_cast<unsigned long long>(stats.overruns),
+                    static_cast<unsigned long long>(stats.dropped_frames),
+                    static_cast<unsigned long long>(stats.stalls));
+    }
+    return decoded > 0 ? 0 : 1;
+}
+
+static int cmd_scan(btccw::node::NodeEngine& engine, double seconds) {
+    std::printf("[scan] capturing %.1f seconds of audio...\n", seconds);
     auto pcm = engine.listen(seconds);
-    std::printf("[listen] captured %zu samples\n", pcm.size());
+    std::printf("[scan] captured %zu samples\n", pcm.size());
 
-    auto result = engine.decode_audio(pcm);
-    if (result.success) {
-        std::printf("[listen] decoded TX: %s\n", result.hex_string.c_str());
-    } else {
-        std::fprintf(stderr, "[listen] decode failed at stage '%s': %s\n",
-                     stage_name(result.stage_reached), result.error.c_str());
-        if (!result.morse_text.empty()) {
-            std::fprintf(stderr, "[listen] morse text: %s\n",
-                         result.morse_text.c_str());
+    auto results = engine.decode_audio_multi(pcm);
+    int decoded = 0;
+    for (const auto& result : results) {
+        if (result.success) {
+            ++decoded;
+            std::printf("[scan] %.0f Hz, %.0f WPM: decoded TX: %s\n",
+                        result.tone_freq_hz, result.wpm, result.hex_string.c_str());
+        } else if (result.fragment.count > 0) {
+            print_fragment(engine, "scan", result);
+        } else {
+            std::fprintf(stderr, "[scan] %.0f Hz: frame failed at stage '%s': %s\n",
+                         result.tone_freq_hz, stage_name(result.stage_reached),
+                         result.error.c_str());
         }
     }
-    return result.success ? 0 : 1;
+    if (results.empty()) {
+        std::fprintf(stderr, "[scan] no frame recovered\n");
+    }
+    return decoded > 0 ? 0 : 1;
 }
 
 static int cmd_broadcast(btccw::node::NodeEngine& engine, const char* hex) {
@@ -83,7 +187,160 @@ static int cmd_broadcast(btccw::node::NodeEngine& engine, const char* hex) {
     return 0;
 }
 
-static int cmd_loopback(btccw::node::NodeEngine& engine, const char* hex) {
+static int cmd_broadcast_batch(btccw::node::NodeEngine& engine,
+                               const std::vector<std::string_view>& hexes) {
+    std::printf("[broadcast] sending %zu transactions to network...\n", hexes.size());
+    auto results = engine.broadcast_batch(hexes);
+    int failed = 0;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i].success) {
+            std::printf("[broadcast] %zu: txid %s\n", i + 1, results[i].txid.c_str());
+        } else {
+            ++failed;
+            std::fprintf(stderr, "[broadcast] %zu: failed: %s\n", i + 1,
+                         results[i].error.c_str());
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+/// "1:02:03.4" for an offset into a recording.
+static std::string format_offset(double seconds) {
+    const long tenths = std::lround(seconds * 10.0);
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%ld:%02ld:%02ld.%ld", tenths / 36000,
+                  tenths / 600 % 60, tenths / 10 % 60, tenths % 10);
+    return buf;
+}
+
+static int cmd_decode_file(std::vector<std::string> args) {
+    // Leading options, each with a value.
+    btccw::node::FileDecodeConfig cfg;
+    std::size_t first = 0;
+    for (; first + 1 < args.size() && args[first].rfind("--", 0) == 0; first += 2) {
+        const std::string& opt = args[first];
+        const std::string& val = args[first + 1];
+        if (opt == "--threads") {
+            cfg.threads = static_cast<std::size_t>(std::max(std::stoi(val), 0));
+        } else if (opt == "--chunk") {
+            cfg.chunk_s = std::stod(val);
+        } else if (opt == "--max-frame") {
+            cfg.max_frame_s = std::stod(val);
+        } else {
+            std::fprintf(stderr, "[decode-file] unknown option %s\n", opt.c_str());
+            return 1;
+        }
+    }
+    args.erase(args.begin(), args.begin() + static_cast<std::ptrdiff_t>(first));
+
+    btccw::node::FileDecoder decoder(cfg);
+    const auto paths = btccw::node::FileDecoder::expand(args);
+    if (paths.empty()) {
+        std::fprintf(stderr, "[decode-file] no recordings found\n");
+        return 1;
+    }
+
+    int decoded = 0;
+    decoder.decode_all(paths, [&](const btccw::node::FileDecodeResult& file) {
+        const char* path = file.path.c_str();
+        if (!file.opened) {
+            std::fprintf(stderr, "[decode-file] %s: %s\n", path, file.error.c_str());
+            return;
+        }
+        std::printf("[decode-file] %s: %s in %zu chunk(s), %zu frame(s)\n", path,
+                    format_offset(file.duration_s).c_str(), file.chunks, file.frames.size());
+        for (const auto& frame : file.frames) {
+            const auto& result = frame.result;
+            const std::string at = format_offset(frame.offset_s);
+            if (result.success) {
+                ++decoded;
+                std::printf("[decode-file] %s @ %s (%.0f WPM): decoded TX: %s\n", path,
+                            at.c_str(), result.wpm, result.hex_string.c_str());
+            } else if (result.fragment.count > 0) {
+                std::printf("[decode-file] %s @ %s: TX %s: fragment %zu of %zu\n", path,
+                            at.c_str(), result.fragment.tx_id.c_str(),
+                            result.fragment.index, result.fragment.count);
+            } else {
+                std::fprintf(stderr, "[decode-file] %s @ %s: frame failed at stage '%s': %s\n",
+                             path, at.c_str(), stage_name(result.stage_reached),
+                             result.error.c_str());
+            }
+        }
+        std::fflush(stdout);
+    });
+    return decoded > 0 ? 0 : 1;
+}
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void on_signal(int) { g_stop = 1; }
+
+static void print_daemon_stats(const btccw::node::Daemon& daemon,
+                               const btccw::node::NodeEngine& engine) {
+    auto stats   = daemon.stats();
+    auto capture = engine.capture_stats();
+    std::printf("[daemon] %llu frames, %llu TX decoded, %llu broadcast, %llu failed, "
+                "%llu dropped, %zu queued; ring high water %zu/%zu, %llu overruns, "
+                "%llu stalls\n",
+                static_cast<unsigned long long>(stats.frames),
+                static_cast<unsigned long long>(stats.transactions),
+                static_cast<unsigned long long>(stats.broadcast),
+                static_cast<unsigned long long>(stats.failed),
+                static_cast<unsigned long long>(stats.dropped), stats.queued,
+                capture.high_water, capture.capacity,
+                static_cast<unsigned long long>(capture.overruns),
+                static_cast<unsigned long long>(capture.stalls));
+    auto cache = engine.txid_cache_stats();
+    std::printf("[daemon] repeats answered locally: %llu of %llu\n",
+                static_cast<unsigned long long>(cache.hits),
+                static_cast<unsigned long long>(cache.hits + cache.misses));
+    auto gateway = engine.gateway_stats();
+    if (gateway.endpoints.size() > 1) {
+        for (const auto& endpoint : gateway.endpoints) {
+            std::printf("[daemon]   %s: %llu requests, %llu answered, %llu errors, "
+                        "%.0f ms%s\n",
+                        endpoint.url.c_str(),
+                        static_cast<unsigned long long>(endpoint.requests),
+                        static_cast<unsigned long long>(endpoint.answered),
+                        static_cast<unsigned long long>(endpoint.errors),
+                        endpoint.latency_s * 1000.0, endpoint.healthy ? "" : ", unhealthy");
+        }
+    }
+    std::fflush(stdout);
+}
+
+static int cmd_daemon(btccw::node::NodeEngine& engine,
+                      const btccw::node::DaemonConfig& cfg) {
+    std::signal(SIGTERM, on_signal);
+    std::signal(SIGINT, on_signal);
+
+    btccw::node::Daemon daemon(engine, cfg);
+    if (!daemon.start()) {
+        std::fprintf(stderr, "error: could not start continuous capture\n");
+        return 1;
+    }
+    std::puts("[daemon] listening; SIGTERM or Ctrl-C to stop");
+    std::fflush(stdout);
+
+    // The threads do the work; this one waits for a signal and reports.
+    constexpr auto kStatsInterval = std::chrono::minutes(10);
+    auto next_stats = std::chrono::steady_clock::now() + kStatsInterval;
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (std::chrono::steady_clock::now() >= next_stats) {
+            print_daemon_stats(daemon, engine);
+            next_stats += kStatsInterval;
+        }
+    }
+
+    std::puts("[daemon] stopping; broadcasting what is queued");
+    daemon.stop();
+    print_daemon_stats(daemon, engine);
+    return 0;
+}
+
+static int cmd_loopback(btccw::node::NodeEngine& engine, const char* hex,
+                        bool fragmented) {
     std::puts("=== Acoustic Loopback Test ===\n");
 
     // 1. Validate & encode
@@ -107,8 +364,19 @@ static int cmd_loopback(btccw::node::NodeEngine& engine, const char* hex) {
     auto pcm = engine.listen(duration);
     std::printf("[3/4] captured %zu samples\n", pcm.size());
 
-    // 4. Decode
-    auto result = engine.decode_audio(pcm);
+    // 4. Decode. Fragments are separate frames: scan the capture for all
+    //    of them; the last one completes the transaction.
+    btccw::node::DecodeResult result;
+    if (fragmented) {
+        auto frames = engine.decode_audio_multi(pcm);
+        result.error = "no complete transaction in " + std::to_string(frames.size()) +
+                       " frame(s)";
+        for (auto& frame : frames) {
+            if (frame.success) result = std::move(frame);
+        }
+    } else {
+        result = engine.decode_audio(pcm);
+    }
     if (result.success) {
         std::printf("[4/4] decoded TX: %s\n", result.hex_string.c_str());
         if (result.hex_string == hex) {
@@ -148,12 +416,41 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // Recordings need neither audio devices nor the network.
+    if (std::strcmp(cmd, "decode-file") == 0 && argc >= 3) {
+        return cmd_decode_file(std::vector<std::string>(argv + 2, argv + argc));
+    }
+
     // Initialise the engine with default config.
     btccw::node::NodeEngine engine;
     btccw::node::AudioConfig audio_cfg;
     btccw::node::GatewayConfig gw_cfg;
+    btccw::node::DecodeConfig decode_cfg;
+    btccw::node::FrameConfig frame_cfg;
+    btccw::node::DaemonConfig daemon_cfg;
 
-    if (!engine.init(audio_cfg, gw_cfg)) {
+    if (std::strcmp(cmd, "scan") == 0) {
+        // Default band covers the usual 600-900 Hz operator pitches.
+        double lo   = (argc >= 4) ? std::stod(argv[3]) : 600.0;
+        double hi   = (argc >= 5) ? std::stod(argv[4]) : 900.0;
+        int    bins = (argc >= 6) ? std::stoi(argv[5]) : 16;
+        decode_cfg.channel_freqs = btccw::node::GoertzelBank::spread(
+            lo, hi, static_cast<std::size_t>(std::max(bins, 1)));
+    }
+
+    if (std::strcmp(cmd, "daemon") == 0 && argc >= 3) {
+        daemon_cfg.queue_depth = static_cast<std::size_t>(std::max(std::stoi(argv[2]), 1));
+    }
+
+    if ((std::strcmp(cmd, "tx") == 0 || std::strcmp(cmd, "loopback") == 0) && argc >= 4) {
+        // Reed-Solomon parity per codeword; 0 keeps the CRC-only frame.
+        frame_cfg.fec_parity = static_cast<std::size_t>(std::max(std::stoi(argv[3]), 0));
+        if (argc >= 5) {
+            frame_cfg.fragment_chars = static_cast<std::size_t>(std::max(std::stoi(argv[4]), 0));
+        }
+    }
+
+    if (!engine.init(audio_cfg, gw_cfg, decode_cfg, frame_cfg)) {
         std::fprintf(stderr, "error: failed to initialise engine\n");
         return 1;
     }
@@ -161,13 +458,22 @@ int main(int argc, char* argv[]) {
     int rc = 1;
 
     if (std::strcmp(cmd, "tx") == 0 && argc >= 3) {
-        rc = cmd_tx(engine, argv[2]);
+        rc = cmd_tx(engine, argv[2],
+                    argc >= 6 ? parse_indices(argv[5]) : std::vector<std::size_t>{});
     } else if (std::strcmp(cmd, "listen") == 0 && argc >= 3) {
         rc = cmd_listen(engine, std::stod(argv[2]));
+    } else if (std::strcmp(cmd, "scan") == 0 && argc >= 3) {
+        rc = cmd_scan(engine, std::stod(argv[2]));
     } else if (std::strcmp(cmd, "broadcast") == 0 && argc >= 3) {
-        rc = cmd_broadcast(engine, argv[2]);
+        if (argc == 3) {
+            rc = cmd_broadcast(engine, argv[2]);
+        } else {
+            rc = cmd_broadcast_batch(engine, std::vector<std::string_view>(argv + 2, argv + argc));
+        }
+    } else if (std::strcmp(cmd, "daemon") == 0) {
+        rc = cmd_daemon(engine, daemon_cfg);
     } else if (std::strcmp(cmd, "loopback") == 0 && argc >= 3) {
-        rc = cmd_loopback(engine, argv[2]);
+        rc = cmd_loopback(engine, argv[2], frame_cfg.fragment_chars > 0);
     } else {
         print_usage();
     }
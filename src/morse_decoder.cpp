@@ -1,123 +1,303 @@
 #include "morse_decoder.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
 #include <btccw/morse.hpp>
 
 namespace btccw::node {
 
-MorseDecoder::MorseDecoder(int blocks_per_unit)
-    : blocks_per_unit_(blocks_per_unit) {
+MorseDecoder::MorseDecoder(int blocks_per_unit, bool auto_speed)
+    : blocks_per_unit_(blocks_per_unit),
+      auto_speed_(auto_speed),
+      run_bins_(static_cast<std::size_t>(
+          std::ceil(std::max(blocks_per_unit, 1) * kMaxSpeedRatio * kMaxRunUnits)) + 1) {
     build_reverse_table();
 }
 
 void MorseDecoder::build_reverse_table() {
     // Build reverse table from MorseEncoder::lookup() for all supported chars.
-    // Letters A-Z
-    for (char c = 'A'; c <= 'Z'; ++c) {
+    auto add = [this](char c) {
         const char* pattern = btccw::MorseEncoder::lookup(c);
-        if (pattern) {
-            reverse_table_[pattern] = c;
+        if (unsigned key = pattern ? pattern_key(pattern) : 0u) {
+            table_[key] = c;
         }
-    }
+    };
+    // Letters A-Z
+    for (char c = 'A'; c <= 'Z'; ++c) add(c);
     // Digits 0-9
-    for (char c = '0'; c <= '9'; ++c) {
-        const char* pattern = btccw::MorseEncoder::lookup(c);
-        if (pattern) {
-            reverse_table_[pattern] = c;
+    for (char c = '0'; c <= '9'; ++c) add(c);
+    // Punctuation used in Base43 charset
+    for (char c : {'+', '/', '.', ':', '-', '?'}) add(c);
+    // Space is implicit (word gap), not in lookup table.
+}
+
+unsigned MorseDecoder::pattern_key(const char* pattern) noexcept {
+    unsigned bits = 0;
+    std::size_t len = 0;
+    for (; pattern[len] != '\0'; ++len) {
+        if (len == kMaxElements) return 0;
+        if (pattern[len] == '-') bits |= 1u << len;
+    }
+    return len ? ((1u << len) | bits) : 0u;
+}
+
+void MorseDecoder::add_element(StreamState& st, bool dash) noexcept {
+    // Past kMaxElements the length keeps counting (saturating) so the
+    // character resolves to '?'.
+    if (st.len < kMaxElements && dash) st.bits |= static_cast<uint8_t>(1u << st.len);
+    if (st.len <= kMaxElements) ++st.len;
+}
+
+void MorseDecoder::emit_pattern(StreamState& st, std::string& out) const {
+    if (st.len == 0) return;
+    const unsigned key = pattern_key(st.bits, st.len);
+    if (char c = symbol(key)) {
+        out += c;
+    } else {
+        // Unknown pattern: placeholder in band, what it might be out of band.
+        st.erasures.push_back({out.size(), repair_candidates(key)});
+        out += '?';
+    }
+    st.bits = 0;
+    st.len  = 0;
+}
+
+std::vector<std::string> MorseDecoder::repair_candidates(unsigned key) const {
+    std::vector<std::string> out;
+    if (key < 2 || key >= table_.size()) return out;   // empty or overflowed
+
+    unsigned len = 0;
+    while ((key >> (len + 1)) != 0) ++len;
+    const unsigned bits = key & ((1u << len) - 1);
+
+    auto add = [&](std::string s) {
+        if (out.size() < kMaxRepairCandidates &&
+            std::find(out.begin(), out.end(), s) == out.end()) {
+            out.push_back(std::move(s));
         }
+    };
+    auto add_key = [&](unsigned b, unsigned l) {
+        if (l == 0 || l > kMaxElements) return;
+        if (char c = symbol(pattern_key(static_cast<uint8_t>(b), static_cast<uint8_t>(l)))) {
+            add(std::string(1, c));
+        }
+    };
+
+    // A dot read as a dash or the other way round.
+    for (unsigned i = 0; i < len; ++i) add_key(bits ^ (1u << i), len);
+    // A character gap read as an element gap: two characters run together.
+    for (unsigned i = 1; i < len; ++i) {
+        const char first  = symbol((1u << i) | (bits & ((1u << i) - 1)));
+        const char second = symbol((1u << (len - i)) | (bits >> i));
+        if (first && second) add(std::string{first, second});
     }
-    // Punctuation used in Base43 charset
-    for (char c : {'+', '/', '.', ':', '-', '?'}) {
-        const char* pattern = btccw::MorseEncoder::lookup(c);
-        if (pattern) {
-            reverse_table_[pattern] = c;
+    // A noise burst keyed an extra element, or a fade dropped one.
+    for (unsigned i = 0; i < len; ++i) {
+        add_key((bits & ((1u << i) - 1)) | ((bits >> (i + 1)) << i), len - 1);
+    }
+    for (unsigned i = 0; i <= len; ++i) {
+        for (unsigned dash = 0; dash < 2; ++dash) {
+            add_key((bits & ((1u << i) - 1)) | (dash << i) | ((bits >> i) << (i + 1)),
+                    len + 1);
         }
     }
-    // Space is implicit (word gap), not in lookup table.
+    return out;
 }
 
-std::string MorseDecoder::decode(const std::vector<bool>& tones) const {
+std::string MorseDecoder::decode(const ToneBits& tones, double* unit_out,
+                                 std::vector<Erasure>* erasures) const {
     if (tones.empty()) return {};
+    const std::size_t n = tones.size();
 
-    // Convert boolean stream to run-length pairs: (is_on, length).
-    struct Run {
-        bool on;
-        int  length;
-    };
-    std::vector<Run> runs;
+    StreamState st;
+    if (auto_speed_) {
+        // Start from the speed of the whole stream rather than the guess.
+        std::vector<uint32_t> hist(run_bins_);
+        for (std::size_t i = tones.find_next(0, true); i < n;) {
+            std::size_t end = tones.find_next(i, false);
+            ++hist[std::min(end - i, run_bins_ - 1)];
+            i = tones.find_next(end, true);
+        }
+        st.unit   = clamp_unit(cluster_unit(hist.data(), hist.size()));
+        st.locked = st.unit > 0.0;
+    }
 
-    bool current = tones[0];
-    int  count   = 1;
-    for (std::size_t i = 1; i < tones.size(); ++i) {
-        if (tones[i] == current) {
-            ++count;
-        } else {
-            runs.push_back({current, count});
-            current = tones[i];
-            count = 1;
+    std::string result;
+    bool on = tones[0];
+    for (std::size_t i = 0; i < n; on = !on) {
+        std::size_t end = tones.find_next(i, !on);
+        push_run(st, on, static_cast<int>(end - i), result);
+        i = end;
+    }
+    if (unit_out) *unit_out = unit(st);
+    flush(st, result);
+    if (erasures) *erasures = std::move(st.erasures);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Speed estimation
+// ---------------------------------------------------------------------------
+
+double MorseDecoder::cluster_unit(const uint32_t* hist, std::size_t bins) {
+    double count = 0.0, total = 0.0;
+    for (std::size_t i = 0; i < bins; ++i) {
+        count += hist[i];
+        total += static_cast<double>(i) * hist[i];
+    }
+    if (count < kMinRuns) return 0.0;
+
+    // Two-class split of the lengths with the largest between-class
+    // variance (Otsu): dots below `t`, dashes from `t` up.
+    double best = 0.0, dot = 0.0, dash = 0.0;
+    double n1 = 0.0, s1 = 0.0;
+    for (std::size_t t = 1; t < bins; ++t) {
+        n1 += hist[t - 1];
+        s1 += static_cast<double>(t - 1) * hist[t - 1];
+        const double n2 = count - n1;
+        if (n1 == 0.0 || n2 == 0.0) continue;
+        const double m1 = s1 / n1;
+        const double m2 = (total - s1) / n2;
+        const double between = n1 * n2 * (m2 - m1) * (m2 - m1);
+        if (between > best) {
+            best = between;
+            dot  = m1;
+            dash = m2;
         }
     }
-    runs.push_back({current, count});
 
-    // Timing thresholds (in blocks):
-    //   dot vs dash boundary:        2 * blocks_per_unit
-    //   intra-char vs inter-char:    2 * blocks_per_unit
-    //   inter-char vs word gap:      5 * blocks_per_unit
-    int dot_dash_threshold = 2 * blocks_per_unit_;
-    int word_gap_threshold = 5 * blocks_per_unit_;
+    // A dash is three units and a dot one; detector hysteresis stretches
+    // both by about the same amount, so use their difference.
+    if (dot <= 0.0 || dash < kMinDashRatio * dot || dash > kMaxDashRatio * dot) return 0.0;
+    return (dash - dot) / 2.0;
+}
 
-    std::string result;
-    std::string current_pattern; // accumulates dots/dashes for one character
-
-    for (const auto& run : runs) {
-        if (run.on) {
-            // ON run: classify as dot or dash.
-            if (run.length < dot_dash_threshold) {
-                current_pattern += '.';
-            } else {
-                current_pattern += '-';
-            }
-        } else {
-            // OFF run: classify gap type.
-            if (run.length < dot_dash_threshold) {
-                // Intra-character gap — do nothing, elements accumulate.
-            } else if (run.length < word_gap_threshold) {
-                // Inter-character gap — flush current character.
-                if (!current_pattern.empty()) {
-                    auto it = reverse_table_.find(current_pattern);
-                    if (it != reverse_table_.end()) {
-                        result += it->second;
-                    } else {
-                        result += '?'; // unknown pattern
-                    }
-                    current_pattern.clear();
-                }
-            } else {
-                // Word gap — flush character then add space.
-                if (!current_pattern.empty()) {
-                    auto it = reverse_table_.find(current_pattern);
-                    if (it != reverse_table_.end()) {
-                        result += it->second;
-                    } else {
-                        result += '?';
-                    }
-                    current_pattern.clear();
-                }
-                result += ' ';
-            }
+double MorseDecoder::clamp_unit(double unit) const noexcept {
+    if (unit <= 0.0) return 0.0;
+    const double bpu = std::max(blocks_per_unit_, 1);
+    return std::clamp(unit, bpu / kMaxSpeedRatio, bpu * kMaxSpeedRatio);
+}
+
+void MorseDecoder::track_run(StreamState& st, int length) const {
+    st.runs[st.runs_pos] = length;
+    st.runs_pos = (st.runs_pos + 1) % kRunHistory;
+    if (st.runs_len < kRunHistory) ++st.runs_len;
+
+    // Bins past the longest run are empty and cannot move the split, so
+    // the histogram only reaches that far.
+    std::size_t longest = 0;
+    for (std::size_t i = 0; i < st.runs_len; ++i) {
+        longest = std::max(longest, static_cast<std::size_t>(st.runs[i]));
+    }
+    const std::size_t bins = std::min(longest, run_bins_ - 1) + 1;
+    st.hist.assign(bins, 0);
+    for (std::size_t i = 0; i < st.runs_len; ++i) {
+        ++st.hist[std::min<std::size_t>(static_cast<std::size_t>(st.runs[i]), bins - 1)];
+    }
+    double estimate = clamp_unit(cluster_unit(st.hist.data(), bins));
+    if (estimate > 0.0) st.unit = estimate;
+}
+
+// Timing thresholds (in blocks, u = current unit):
+//   dot vs dash boundary:        2 * u
+//   intra-char vs inter-char:    2 * u
+//   inter-char vs word gap:      5 * u
+
+void MorseDecoder::warmup_run(StreamState& st, std::string& out) const {
+    if (st.on) {
+        st.pending[st.pending_len++] = st.count;
+        track_run(st, st.count);
+    } else if (st.pending_len > 0) {
+        // Leading silence carries no text.
+        st.pending[st.pending_len++] = -st.count;
+    }
+    if (st.unit > 0.0 || st.pending_len == kMaxPendingRuns) replay(st, out);
+}
+
+void MorseDecoder::replay(StreamState& st, std::string& out) const {
+    const int dot_dash = dot_dash_threshold(st);
+    const int word_gap = word_gap_threshold(st);
+    for (std::size_t i = 0; i < st.pending_len; ++i) {
+        const int run = st.pending[i];
+        if (run > 0) {
+            add_element(st, run >= dot_dash);
+            continue;
+        }
+        // Same boundaries push() applies while an OFF run grows.
+        if (-run >= std::max(dot_dash, 1)) emit_pattern(st, out);
+        if (-run >= std::max(word_gap, 1)) {
+            emit_pattern(st, out);
+            out += ' ';
         }
     }
+    st.pending_len = 0;
+    st.locked = true;
+}
 
-    // Flush any remaining pattern.
-    if (!current_pattern.empty()) {
-        auto it = reverse_table_.find(current_pattern);
-        if (it != reverse_table_.end()) {
-            result += it->second;
-        } else {
-            result += '?';
+void MorseDecoder::end_on_run(StreamState& st, int length) const {
+    if (auto_speed_) track_run(st, length);
+    add_element(st, length >= dot_dash_threshold(st));
+}
+
+void MorseDecoder::push_run(StreamState& st, bool tone, int length, std::string& out) const {
+    if (length <= 0) return;
+
+    if (st.count > 0 && tone != st.on) {
+        // Run boundary. An ON run is classified once it ends; OFF runs were
+        // already acted on while they grew.
+        if (auto_speed_ && !st.locked) {
+            warmup_run(st, out);
+        } else if (st.on) {
+            end_on_run(st, st.count);
         }
+        st.count = 0;
     }
+    st.on = tone;
+    const int from = st.count;
+    st.count += length;
 
-    return result;
+    if (st.on || (auto_speed_ && !st.locked)) return;
+
+    // OFF run: flush the character at the inter-character boundary and add
+    // a space at the word-gap boundary — each exactly once per run, when
+    // the run grows past it.
+    auto crosses = [&](int threshold) {
+        threshold = std::max(threshold, 1);
+        return from < threshold && threshold <= st.count;
+    };
+    if (crosses(dot_dash_threshold(st))) {
+        emit_pattern(st, out);
+    }
+    if (crosses(word_gap_threshold(st))) {
+        emit_pattern(st, out);
+        out += ' ';
+    }
+    if (auto_speed_ && crosses(idle_threshold(st))) {
+        // End of transmission: measure the next sender from scratch.
+        st.unit     = 0.0;
+        st.runs_len = 0;
+        st.runs_pos = 0;
+        st.locked   = false;
+    }
+}
+
+void MorseDecoder::flush(StreamState& st, std::string& out) const {
+    const bool warming = auto_speed_ && !st.locked;
+    if (st.count > 0 && st.on) {
+        if (warming) {
+            st.pending[st.pending_len++] = st.count;
+            track_run(st, st.count);
+        } else {
+            end_on_run(st, st.count);
+        }
+    }
+    if (warming) replay(st, out);
+    emit_pattern(st, out);
+    std::vector<Erasure> erasures = std::move(st.erasures);
+    st = StreamState{};
+    st.erasures = std::move(erasures);
 }
 
 } // namespace btccw::node
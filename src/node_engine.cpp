@@ -1,16 +1,21 @@
 #include "node_engine.hpp"
 
 #include <cstdio>
+#include <utility>
 
-#include <btccw/base43.hpp>
 #include <btccw/checksum.hpp>
 #include <btccw/morse.hpp>
 #include <btccw/transaction.hpp>
 
+#include "base43_codec.hpp"
+#include "txid.hpp"
+
 namespace btccw::node {
 
 bool NodeEngine::init(const AudioConfig& audio_cfg,
-                      const GatewayConfig& gw_cfg) {
+                      const GatewayConfig& gw_cfg,
+                      const DecodeConfig& decode_cfg,
+                      const FrameConfig& frame_cfg) {
     if (!audio_.open(audio_cfg)) {
         std::fprintf(stderr, "[engine] audio init failed\n");
         return false;
@@ -21,14 +26,20 @@ bool NodeEngine::init(const AudioConfig& audio_cfg,
     }
 
     // Construct the decode pipeline with audio config params.
-    decode_pipeline_ = std::make_unique<DecodePipeline>(
-        audio_cfg.sample_rate, audio_cfg.tone_freq_hz,
-        audio_cfg.wpm);
+    DecodeConfig rx_cfg = decode_cfg;
+    rx_cfg.sample_rate  = audio_cfg.sample_rate;
+    rx_cfg.tone_freq    = audio_cfg.tone_freq_hz;
+    rx_cfg.wpm          = audio_cfg.wpm;
+    decode_pipeline_ = std::make_unique<DecodePipeline>(rx_cfg);
+    frame_cfg_ = frame_cfg;
+    reassembler_ = Reassembler(decode_cfg.reassembly);
+    txid_cache_.reset(gw_cfg.dedupe);
 
     return true;
 }
 
 void NodeEngine::shutdown() {
+    stop_listening();
     decode_pipeline_.reset();
     audio_.close();
     gateway_.close();
@@ -38,7 +49,8 @@ void NodeEngine::shutdown() {
 // Transmit path
 // ---------------------------------------------------------------------------
 
-std::vector<int8_t> NodeEngine::encode_tx(std::string_view raw_tx_hex) {
+std::vector<int8_t> NodeEngine::encode_tx(std::string_view raw_tx_hex,
+                                          const std::vector<std::size_t>& fragments) {
     // 1. Validate the transaction structure & signatures.
     if (!btccw::Transaction::validate(raw_tx_hex)) {
         std::fprintf(stderr, "[engine] transaction validation failed\n");
@@ -47,19 +59,54 @@ std::vector<int8_t> NodeEngine::encode_tx(std::string_view raw_tx_hex) {
 
     // 2. Convert hex to raw bytes, then Base43-encode.
     auto raw_bytes = btccw::Transaction::hex_to_bytes(raw_tx_hex);
-    std::string b43 = btccw::Base43::encode(raw_bytes);
+    std::string b43 = Base43Codec::encode(raw_bytes);
 
-    // 3. Wrap in protocol frame: KKK <payload><crc> AR
-    std::string framed = btccw::Checksum::frame(b43);
+    // 3. Split a long payload into fragments, each framed on its own.
+    std::vector<std::string> payloads{b43};
+    if (frame_cfg_.fragment_chars > 0 && b43.size() > frame_cfg_.fragment_chars) {
+        payloads = Fragmenter::split(b43, frame_cfg_.fragment_chars);
+        if (payloads.empty()) {
+            std::fprintf(stderr, "[engine] payload needs too many fragments\n");
+            return {};
+        }
+        const std::size_t total = payloads.size();
+        if (!fragments.empty()) {
+            std::vector<std::string> picked;
+            for (std::size_t i : fragments) {
+                if (i < payloads.size()) picked.push_back(payloads[i]);
+            }
+            payloads = std::move(picked);
+        }
+        std::printf("[engine] %zu of %zu fragments, TX %s\n", payloads.size(), total,
+                    Fragmenter::tx_id(b43).c_str());
+    }
+
+    // 4. Wrap each in a protocol frame: KKK <payload><crc> AR, or the
+    //    version 2 Reed-Solomon frame when parity is configured. Frames
+    //    go out back to back, one word gap apart.
+    std::string framed;
+    for (const auto& payload : payloads) {
+        std::string frame = frame_cfg_.fec_parity > 0
+                                ? FecFramer::frame(payload, frame_cfg_.fec_parity)
+                                : btccw::Checksum::frame(payload);
+        if (frame.empty()) {
+            std::fprintf(stderr, "[engine] payload too long to frame\n");
+            return {};
+        }
+        if (!framed.empty()) framed += ' ';
+        framed += frame;
+    }
+    if (framed.empty()) return {};
 
     std::printf("[engine] framed payload: %zu chars\n", framed.size());
 
-    // 4. Convert to Morse timing array.
+    // 5. Convert to Morse timing array.
     return btccw::MorseEncoder::encode(framed);
 }
 
-bool NodeEngine::play(const std::vector<int8_t>& timing) {
-    return audio_.transmit(timing);
+bool NodeEngine::play(const std::vector<int8_t>& timing,
+                      const AudioIO::ProgressCallback& on_progress) {
+    return audio_.transmit(timing, on_progress);
 }
 
 bool NodeEngine::transmit(std::string_view raw_tx_hex) {
@@ -81,7 +128,16 @@ DecodeResult NodeEngine::decode_audio(const std::vector<float>& pcm) {
         return {DecodeStage::None, false, {}, {}, {}, {}, {},
                 "decode pipeline not initialized"};
     }
-    return decode_pipeline_->decode(pcm);
+    DecodeResult result = decode_pipeline_->decode(pcm);
+    collect(result);
+    return result;
+}
+
+std::vector<DecodeResult> NodeEngine::decode_audio_multi(const std::vector<float>& pcm) {
+    if (!decode_pipeline_) return {};
+    auto results = decode_pipeline_->decode_multi(pcm);
+    for (auto& result : results) collect(result);
+    return results;
 }
 
 DecodeResult NodeEngine::listen_and_decode(double duration_sec) {
@@ -89,16 +145,140 @@ DecodeResult NodeEngine::listen_and_decode(double duration_sec) {
     return decode_audio(pcm);
 }
 
+std::size_t NodeEngine::listen_stream(
+    double duration_sec, const StreamingDecoder::FrameCallback& on_frame) {
+    if (!decode_pipeline_) return 0;
+
+    std::size_t frames = 0;
+    StreamingDecoder decoder(*decode_pipeline_, [&](const DecodeResult& r) {
+        ++frames;
+        DecodeResult result = r;
+        collect(result);
+        if (on_frame) on_frame(result);
+    });
+
+    audio_.capture(duration_sec, [&](const float* samples, std::size_t count) {
+        decoder.push(samples, count);
+    });
+    decoder.flush();
+    return frames;
+}
+
+bool NodeEngine::start_listening(StreamingDecoder::FrameCallback on_frame) {
+    if (!decode_pipeline_ || listener_) return false;
+
+    listener_ = std::make_unique<StreamingDecoder>(
+        *decode_pipeline_, [this, cb = std::move(on_frame)](const DecodeResult& r) {
+            DecodeResult result = r;
+            collect(result);
+            if (cb) cb(result);
+        });
+
+    StreamingDecoder* decoder = listener_.get();
+    if (!audio_.start_capture([decoder](const float* samples, std::size_t count) {
+            decoder->push(samples, count);
+        })) {
+        listener_.reset();
+        return false;
+    }
+    return true;
+}
+
+void NodeEngine::stop_listening() {
+    if (!listener_) return;
+    audio_.stop_capture();
+    listener_->flush();
+    listener_.reset();
+}
+
+void NodeEngine::collect(DecodeResult& result) {
+    decode_pipeline_->reassemble(reassembler_, result);
+}
+
 // ---------------------------------------------------------------------------
 // Network
 // ---------------------------------------------------------------------------
 
+bool NodeEngine::already_broadcast(std::string_view raw_tx_hex, std::string& txid) {
+    if (!compute_txid(btccw::Transaction::hex_to_bytes(raw_tx_hex), txid)) {
+        txid.clear();
+        return false;
+    }
+    return txid_cache_.contains(txid);
+}
+
+void NodeEngine::remember(const std::string& txid, const std::string& reported) {
+    if (txid.empty()) return;
+    if (reported != txid) {
+        std::fprintf(stderr, "[engine] gateway reported txid %s, computed %s\n",
+                     reported.c_str(), txid.c_str());
+    }
+    txid_cache_.insert(txid);
+}
+
 std::string NodeEngine::broadcast(std::string_view raw_tx_hex) {
     if (!btccw::Transaction::validate(raw_tx_hex)) {
         std::fprintf(stderr, "[engine] refusing to broadcast invalid TX\n");
         return {};
     }
-    return gateway_.broadcast(raw_tx_hex);
+    std::string txid;
+    if (already_broadcast(raw_tx_hex, txid)) return txid;
+
+    std::string reported = gateway_.broadcast(raw_tx_hex);
+    if (!reported.empty()) remember(txid, reported);
+    return reported;
+}
+
+std::vector<BroadcastResult> NodeEngine::broadcast_batch(
+    const std::vector<std::string_view>& raw_txs) {
+    std::vector<BroadcastResult> results(raw_txs.size());
+    std::vector<std::string> txids(raw_txs.size());
+    std::vector<std::string_view> send;
+    std::vector<std::size_t> index;
+    for (std::size_t i = 0; i < raw_txs.size(); ++i) {
+        if (!btccw::Transaction::validate(raw_txs[i])) {
+            results[i].error = "invalid transaction";
+        } else if (already_broadcast(raw_txs[i], txids[i])) {
+            results[i].success = true;
+            results[i].cached  = true;
+            results[i].txid    = txids[i];
+        } else {
+            send.push_back(raw_txs[i]);
+            index.push_back(i);
+        }
+    }
+
+    auto sent = gateway_.broadcast_batch(send);
+    for (std::size_t k = 0; k < sent.size(); ++k) {
+        const std::size_t i = index[k];
+        if (sent[k].success) remember(txids[i], sent[k].txid);
+        results[i] = std::move(sent[k]);
+    }
+    return results;
+}
+
+void NodeEngine::broadcast_async(std::string_view raw_tx_hex,
+                                 Gateway::BroadcastCallback done) {
+    BroadcastResult result;
+    if (!btccw::Transaction::validate(raw_tx_hex)) {
+        result.error = "invalid transaction";
+        if (done) done(result);
+        return;
+    }
+    std::string txid;
+    if (already_broadcast(raw_tx_hex, txid)) {
+        result.success = true;
+        result.cached  = true;
+        result.txid    = std::move(txid);
+        if (done) done(result);
+        return;
+    }
+    gateway_.broadcast_async(
+        std::string(raw_tx_hex),
+        [this, txid = std::move(txid), done = std::move(done)](const BroadcastResult& sent) {
+            if (sent.success) remember(txid, sent.txid);
+            if (done) done(sent);
+        });
 }
 
 } // namespace btccw::node
@@ -0,0 +1,77 @@
+#include "noise_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace btccw::node {
+
+NoiseTracker::NoiseTracker(std::size_t window)
+    : window_(std::max<std::size_t>(window, 1)),
+      ring_(window_),
+      hist_(ThresholdEstimator::kHistBins) {}
+
+Thresholds NoiseTracker::update(double mag) {
+    if (window_ == 0) *this = NoiseTracker(1);
+
+    // Evict the oldest sample once the window is full.
+    if (count_ == window_) {
+        const uint16_t oldest = ring_[ring_pos_];
+        remove(oldest & ~kToneFlag);
+        if (oldest & kToneFlag) --on_count_;
+        --count_;
+    }
+
+    const std::size_t bin = ThresholdEstimator::hist_bin(mag);
+    ring_[ring_pos_] = static_cast<uint16_t>(bin);
+    add(bin);
+    ++count_;
+
+    // The key-up share is taken to be the lowest (count - on) samples.
+    // Within it, quantile p of Rayleigh noise power is mean * -ln(1 - p).
+    const std::size_t off_count = count_ - on_count_;
+    settle(floor_, static_cast<std::size_t>(
+        kFloorQuantile * static_cast<double>(off_count - 1)));
+    noise_ = ThresholdEstimator::hist_value(floor_.bin + 0.5) /
+             -std::log1p(-kFloorQuantile);
+
+    // Signal level: median of the key-down share at the top.
+    settle(signal_cursor_, on_count_ ? off_count + on_count_ / 2 : count_ - 1);
+    signal_ = on_count_ ? ThresholdEstimator::hist_value(signal_cursor_.bin + 0.5) : 0.0;
+
+    const double snr = signal_ / noise_;
+    const Thresholds t{noise_ * std::max(std::pow(snr, kOnExponent), kOnSnr),
+                       noise_ * std::max(std::pow(snr, kOffExponent), kOffSnr)};
+
+    tone_ = tone_ ? !(mag < t.off) : (mag >= t.on);
+    if (tone_) {
+        ring_[ring_pos_] |= kToneFlag;
+        ++on_count_;
+    }
+    ring_pos_ = (ring_pos_ + 1) % window_;
+    return t;
+}
+
+void NoiseTracker::add(std::size_t bin) {
+    ++hist_[bin];
+    if (bin < floor_.bin)         ++floor_.below;
+    if (bin < signal_cursor_.bin) ++signal_cursor_.below;
+}
+
+void NoiseTracker::remove(std::size_t bin) {
+    --hist_[bin];
+    if (bin < floor_.bin)         --floor_.below;
+    if (bin < signal_cursor_.bin) --signal_cursor_.below;
+}
+
+void NoiseTracker::settle(Cursor& c, std::size_t target) {
+    while (c.below > target) {
+        --c.bin;
+        c.below -= hist_[c.bin];
+    }
+    while (c.below + hist_[c.bin] <= target) {
+        c.below += hist_[c.bin];
+        ++c.bin;
+    }
+}
+
+} // namespace btccw::node
@@ -0,0 +1,179 @@
+#include "pcm_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace btccw::node {
+
+namespace {
+
+constexpr uint16_t kWaveFormatPcm        = 0x0001;
+constexpr uint16_t kWaveFormatFloat      = 0x0003;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+std::size_t bytes_per_sample(SampleFormat format) {
+    return format == SampleFormat::S16 ? 2 : 4;
+}
+
+bool ends_with(const std::string& s, const char* suffix) {
+    const std::size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+} // namespace
+
+PcmFile::~PcmFile() { close(); }
+
+bool PcmFile::open(const std::string& path, const PcmFormat& raw) {
+    close();
+    error_.clear();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(std::strerror(errno));
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        const int err = errno;
+        ::close(fd);
+        return fail(std::strerror(err));
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return fail("empty file");
+    }
+
+    map_size_ = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int err = errno;
+    ::close(fd);   // the mapping keeps the file
+    if (map == MAP_FAILED) {
+        map_size_ = 0;
+        return fail(std::strerror(err));
+    }
+    map_ = map;
+    ::madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+    const auto* file = static_cast<const uint8_t*>(map_);
+    if (map_size_ >= 12 && std::memcmp(file, "RIFF", 4) == 0 &&
+        std::memcmp(file + 8, "WAVE", 4) == 0) {
+        if (!parse_wav(file, map_size_)) {
+            close();
+            return false;
+        }
+    } else {
+        format_ = raw;
+        if (ends_with(path, ".f32")) format_.format = SampleFormat::F32;
+        if (format_.channels < 1 || format_.sample_rate <= 0.0) {
+            close();
+            return fail("bad raw PCM layout");
+        }
+        data_   = file;
+        frames_ = map_size_ / (bytes_per_sample(format_.format) * format_.channels);
+    }
+    return true;
+}
+
+bool PcmFile::parse_wav(const uint8_t* file, std::size_t size) {
+    bool have_fmt = false;
+    for (std::size_t at = 12; at + 8 <= size;) {
+        const uint8_t* chunk = file + at;
+        const std::size_t body = at + 8;
+        std::size_t length = le32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            if (length < 16 || body + 16 > size) return fail("truncated fmt chunk");
+            const uint8_t* fmt = file + body;
+            uint16_t tag = le16(fmt);
+            const uint16_t bits = le16(fmt + 14);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real tag in its sub-format GUID.
+            if (tag == kWaveFormatExtensible && length >= 26 && body + 26 <= size) {
+                tag = le16(fmt + 24);
+            }
+            if (tag == kWaveFormatPcm && bits == 16) {
+                format_.format = SampleFormat::S16;
+            } else if (tag == kWaveFormatFloat && bits == 32) {
+                format_.format = SampleFormat::F32;
+            } else {
+                return fail("unsupported WAV encoding (format " + std::to_string(tag) +
+                            ", " + std::to_string(bits) + " bits)");
+            }
+            format_.channels    = le16(fmt + 2);
+            format_.sample_rate = le32(fmt + 4);
+            if (format_.channels < 1 || format_.sample_rate <= 0.0) {
+                return fail("bad WAV fmt chunk");
+            }
+            have_fmt = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) return fail("WAV data before fmt chunk");
+            // A recorder that was cut off leaves the size unset or too large.
+            length = std::min(length, size - body);
+            data_   = file + body;
+            frames_ = length / (bytes_per_sample(format_.format) * format_.channels);
+            return true;
+        }
+        at = body + length + (length & 1);   // chunks are word-aligned
+    }
+    return fail(have_fmt ? "WAV has no data chunk" : "WAV has no fmt chunk");
+}
+
+void PcmFile::close() {
+    if (map_) ::munmap(map_, map_size_);
+    map_      = nullptr;
+    map_size_ = 0;
+    data_     = nullptr;
+    frames_   = 0;
+}
+
+std::size_t PcmFile::read(std::size_t first, std::size_t count, float* out) const {
+    if (first >= frames_) return 0;
+    count = std::min(count, frames_ - first);
+
+    const int channels = format_.channels;
+    const std::size_t stride = bytes_per_sample(format_.format) * channels;
+    const uint8_t* p = data_ + first * stride;
+
+    if (format_.format == SampleFormat::S16) {
+        const float scale = 1.0f / (32768.0f * channels);
+        for (std::size_t i = 0; i < count; ++i) {
+            int32_t sum = 0;
+            for (int c = 0; c < channels; ++c, p += 2) {
+                sum += static_cast<int16_t>(le16(p));
+            }
+            out[i] = static_cast<float>(sum) * scale;
+        }
+    } else {
+        const float scale = 1.0f / static_cast<float>(channels);
+        for (std::size_t i = 0; i < count; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c, p += 4) {
+                float sample;
+                std::memcpy(&sample, p, sizeof sample);
+                sum += sample;
+            }
+            out[i] = channels == 1 ? sum : sum * scale;
+        }
+    }
+    return count;
+}
+
+bool PcmFile::fail(std::string why) {
+    error_ = std::move(why);
+    return false;
+}
+
+} // namespace btccw::node
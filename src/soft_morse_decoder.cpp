@@ -0,0 +1,251 @@
+#include "soft_morse_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "noise_tracker.hpp"
+
+namespace btccw::node {
+
+namespace {
+
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+/// log I0(x) for x >= 0 (Abramowitz & Stegun 9.8.1 / 9.8.2).
+double log_bessel_i0(double x) {
+    if (x < 3.75) {
+        const double t = (x / 3.75) * (x / 3.75);
+        return std::log(1.0 + t * (3.5156229 + t * (3.0899424 + t * (1.2067492 +
+                        t * (0.2659732 + t * (0.0360768 + t * 0.0045813))))));
+    }
+    const double t = 3.75 / x;
+    const double p = 0.39894228 + t * (0.01328592 + t * (0.00225319 +
+                     t * (-0.00157565 + t * (0.00916281 + t * (-0.02057706 +
+                     t * (0.02635537 + t * (-0.01647633 + t * 0.00392377)))))));
+    return x - 0.5 * std::log(x) + std::log(p);
+}
+
+/// Number of elements in a packed key.
+unsigned key_length(unsigned key) {
+    unsigned len = 0;
+    while (key > 1) {
+        key >>= 1;
+        ++len;
+    }
+    return len;
+}
+
+} // namespace
+
+SoftMorseDecoder::SoftMorseDecoder(const MorseDecoder& symbols,
+                                   std::size_t beam_width, std::size_t candidates)
+    : beam_width_(std::max<std::size_t>(beam_width, 1)),
+      candidates_(std::max<std::size_t>(candidates, 1)) {
+    for (unsigned key = 1; key < table_.size(); ++key) {
+        table_[key] = symbols.symbol(key);
+        if (!table_[key]) continue;
+        // Every prefix of a character's pattern may still grow into it.
+        for (unsigned len = key_length(key); len > 0; --len) {
+            prefix_[(1u << len) | (key & ((1u << len) - 1))] = true;
+        }
+    }
+}
+
+std::vector<double> SoftMorseDecoder::log_likelihoods(const std::vector<double>& mags,
+                                                      std::size_t noise_window) {
+    const std::size_t n = mags.size();
+    std::vector<double> noise(n), signal(n);
+    NoiseTracker tracker(noise_window);
+    for (std::size_t i = 0; i < n; ++i) {
+        tracker.update(mags[i]);
+        noise[i]  = tracker.noise_floor();
+        signal[i] = tracker.signal();
+    }
+
+    // The tracker lags by about half a window; read its levels that far
+    // ahead so each decision is judged against its own neighbourhood.
+    const std::size_t lag = tracker.window() / 2;
+    std::vector<double> llr(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t j = std::min(i + lag, n - 1);
+        const double nf = noise[j];
+        if (nf <= 0.0) continue;
+        // Key-down power is tone plus noise; assume at least 0 dB SNR.
+        const double a = std::max(signal[j] - nf, nf);
+        // Tone: non-central chi-square (Rician amplitude); no tone:
+        // exponential (Rayleigh amplitude), both with noise power nf.
+        llr[i] = log_bessel_i0(2.0 * std::sqrt(mags[i] * a) / nf) - a / nf;
+    }
+    return llr;
+}
+
+void SoftMorseDecoder::emit(Hypothesis& h, char c) noexcept {
+    h.pend[h.pend_len++] = c;
+    h.hash = (h.hash ^ static_cast<unsigned char>(c)) * kFnvPrime;
+}
+
+std::string SoftMorseDecoder::text_of(const std::vector<TextNode>& arena,
+                                      const Hypothesis& h) {
+    std::string text;
+    for (uint32_t node = h.node; node != 0; node = arena[node].parent) {
+        text += arena[node].c;
+    }
+    std::reverse(text.begin(), text.end());
+    text.append(h.pend, h.pend_len);
+    return text;
+}
+
+void SoftMorseDecoder::prune(std::vector<Hypothesis>& bucket) const {
+    // Same text and Morse state: only the best-scoring path matters.
+    std::sort(bucket.begin(), bucket.end(), [](const Hypothesis& a, const Hypothesis& b) {
+        if (a.hash  != b.hash)  return a.hash  < b.hash;
+        if (a.key   != b.key)   return a.key   < b.key;
+        if (a.phase != b.phase) return a.phase < b.phase;
+        return a.score > b.score;
+    });
+    bucket.erase(std::unique(bucket.begin(), bucket.end(),
+                             [](const Hypothesis& a, const Hypothesis& b) {
+                                 return a.hash == b.hash && a.key == b.key &&
+                                        a.phase == b.phase;
+                             }),
+                 bucket.end());
+
+    if (bucket.size() > beam_width_) {
+        std::nth_element(bucket.begin(), bucket.begin() + beam_width_, bucket.end(),
+                         [](const Hypothesis& a, const Hypothesis& b) {
+                             return a.score > b.score;
+                         });
+        bucket.resize(beam_width_);
+    }
+}
+
+std::vector<SoftCandidate> SoftMorseDecoder::decode(const std::vector<double>& mags,
+                                                    double unit,
+                                                    std::size_t noise_window) const {
+    if (mags.empty() || !(unit > 0.0)) return {};
+    const std::size_t n = mags.size();
+
+    std::vector<double> llr = log_likelihoods(mags, noise_window);
+    std::vector<double> cum(n + 1, 0.0);
+    for (std::size_t i = 0; i < n; ++i) cum[i + 1] = cum[i] + llr[i];
+
+    // Lengths worth trying for each segment kind, with their log prior.
+    // Word gaps have no upper bound: longer silences chain idle segments.
+    static constexpr double kNominal[kSegments] = {1.0, 3.0, 1.0, 3.0, 7.0, 0.0};
+    const std::size_t max_len = std::max<std::size_t>(
+        1, static_cast<std::size_t>(std::ceil(kMaxSegmentUnits * unit)));
+    std::array<std::vector<std::pair<std::size_t, double>>, kSegments> lengths;
+    for (int s = 0; s < kSegments; ++s) {
+        for (std::size_t d = 1; d <= max_len; ++d) {
+            const double nominal = kNominal[s] * unit;
+            double prior = 0.0;
+            if (s != Idle && !(s == WordGap && d >= nominal)) {
+                const double r = std::log(static_cast<double>(d) / nominal);
+                prior = -r * r / (2.0 * kLengthSigma * kLengthSigma);
+            }
+            if (prior >= kMinLengthPrior) lengths[s].emplace_back(d, prior);
+        }
+    }
+
+    // Hypotheses bucketed by end position; no segment spans more than
+    // max_len decisions, so max_len + 1 buckets are live at once.
+    std::vector<std::vector<Hypothesis>> ring(max_len + 1);
+    std::vector<TextNode> arena{{0, '\0'}};
+
+    auto add = [&](std::size_t end, const Hypothesis& h) {
+        auto& bucket = ring[end % ring.size()];
+        if (bucket.size() >= 4 * beam_width_) prune(bucket);
+        bucket.push_back(h);
+    };
+
+    ring[0].push_back(Hypothesis{});
+    for (std::size_t t = 0; t < n; ++t) {
+        auto& bucket = ring[t % ring.size()];
+        if (bucket.empty()) continue;
+        prune(bucket);
+
+        for (Hypothesis& h : bucket) {
+            // Survivors move their emitted characters into the arena.
+            for (uint8_t i = 0; i < h.pend_len; ++i) {
+                arena.push_back({h.node, h.pend[i]});
+                h.node = static_cast<uint32_t>(arena.size() - 1);
+            }
+            h.pend_len = 0;
+
+            if (h.phase != ExpectGap) {
+                const unsigned len = key_length(h.key);
+                for (int s : {Dot, Dash}) {
+                    if (len >= MorseDecoder::kMaxElements) break;
+                    const unsigned key = (h.key + (1u << len)) |
+                                         (s == Dash ? 1u << len : 0u);
+                    if (!prefix_[key]) continue;
+                    for (const auto& [d, prior] : lengths[s]) {
+                        if (t + d > n) break;
+                        Hypothesis next = h;
+                        next.score += cum[t + d] - cum[t] + prior;
+                        next.key   = static_cast<uint8_t>(key);
+                        next.phase = ExpectGap;
+                        add(t + d, next);
+                    }
+                }
+            }
+
+            if (h.phase == ExpectGap) {
+                const char c = table_[h.key];
+                for (int s : {ElementGap, CharGap, WordGap}) {
+                    if (s != ElementGap && !c) continue;
+                    Hypothesis base = h;
+                    if (s != ElementGap) {
+                        emit(base, c);
+                        base.key = 1;
+                    }
+                    if (s == WordGap) emit(base, ' ');
+                    base.phase = s == WordGap ? Between : ExpectTone;
+                    for (const auto& [d, prior] : lengths[s]) {
+                        if (t + d > n) break;
+                        Hypothesis next = base;
+                        next.score += prior;
+                        add(t + d, next);
+                    }
+                }
+            } else if (h.phase == Between) {
+                for (const auto& [d, prior] : lengths[Idle]) {
+                    if (t + d > n) break;
+                    Hypothesis next = h;
+                    next.score += prior;
+                    add(t + d, next);
+                }
+            }
+        }
+        bucket.clear();
+    }
+
+    // Paths covering the whole stream: finish the pending character.
+    auto& last = ring[n % ring.size()];
+    std::vector<std::pair<double, std::string>> finished;
+    for (Hypothesis h : last) {
+        if (h.key != 1) {
+            const char c = table_[h.key];
+            if (!c) continue;
+            emit(h, c);
+        }
+        std::string text = text_of(arena, h);
+        const std::size_t first = text.find_first_not_of(' ');
+        if (first == std::string::npos) continue;
+        text = text.substr(first, text.find_last_not_of(' ') - first + 1);
+        finished.emplace_back(h.score, std::move(text));
+    }
+    std::sort(finished.begin(), finished.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<SoftCandidate> out;
+    for (auto& [score, text] : finished) {
+        if (out.size() == candidates_) break;
+        bool seen = false;
+        for (const auto& c : out) seen = seen || c.text == text;
+        if (!seen) out.push_back({std::move(text), score});
+    }
+    return out;
+}
+
+} // namespace btccw::node
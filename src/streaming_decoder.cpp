@@ -0,0 +1,148 @@
+#include "streaming_decoder.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace btccw::node {
+
+namespace {
+constexpr const char* kPreamble = "KKK ";
+constexpr std::size_t kPreambleLen = 4;
+constexpr const char* kPostamble = " AR";
+constexpr std::size_t kPostambleLen = 3;
+} // namespace
+
+StreamingDecoder::StreamingDecoder(const DecodePipeline& pipeline,
+                                   FrameCallback on_frame)
+    : pipeline_(pipeline), on_frame_(std::move(on_frame)) {}
+
+void StreamingDecoder::push(const float* samples, std::size_t count) {
+    samples_ += count;
+
+    blocks_.clear();
+    pipeline_.detector().push(tone_state_, samples, count, blocks_);
+
+    // Hand the decisions over a run at a time.
+    const std::size_t n = blocks_.size();
+    bool on = n > 0 && blocks_[0];
+    for (std::size_t i = 0; i < n; on = !on) {
+        std::size_t end = blocks_.find_next(i, !on);
+        std::size_t before = text_.size();
+        pipeline_.morse_decoder().push_run(morse_state_, on,
+                                           static_cast<int>(end - i), text_);
+        if (text_.size() != before) {
+            collect_erasures();
+            scan_text(before);
+        }
+        i = end;
+    }
+}
+
+void StreamingDecoder::push_text(const std::string& text,
+                                 const std::vector<Erasure>& erasures) {
+    if (text.empty()) return;
+    std::size_t before = text_.size();
+    text_ += text;
+    for (const auto& e : erasures) {
+        erasures_.push_back(e);
+        erasures_.back().pos += before;
+    }
+    scan_text(before);
+}
+
+void StreamingDecoder::flush() {
+    std::size_t before = text_.size();
+    pipeline_.morse_decoder().flush(morse_state_, text_);
+    collect_erasures();
+    if (text_.size() != before) scan_text(before);
+}
+
+void StreamingDecoder::reset() {
+    tone_state_  = GoertzelDetector::StreamState{};
+    morse_state_ = MorseDecoder::StreamState{};
+    text_.clear();
+    erasures_.clear();
+    samples_ = 0;
+}
+
+bool StreamingDecoder::frame_open() const noexcept {
+    // scan_text() drops everything before the first preamble.
+    return text_.compare(0, kPreambleLen, kPreamble) == 0 &&
+           !pipeline_.morse_decoder().idle(morse_state_);
+}
+
+void StreamingDecoder::collect_erasures() {
+    auto& recorded = morse_state_.erasures;
+    erasures_.insert(erasures_.end(), std::make_move_iterator(recorded.begin()),
+                     std::make_move_iterator(recorded.end()));
+    recorded.clear();
+}
+
+void StreamingDecoder::consume(std::size_t count) {
+    text_.erase(0, count);
+    auto kept = std::find_if(erasures_.begin(), erasures_.end(),
+                             [&](const Erasure& e) { return e.pos >= count; });
+    erasures_.erase(erasures_.begin(), kept);
+    for (auto& e : erasures_) e.pos -= count;
+}
+
+void StreamingDecoder::scan_text(std::size_t from) {
+    // A frame can only end on a character that completes " AR".
+    std::size_t i = from;
+    while (i < text_.size()) {
+        std::size_t end = i + 1;
+        if (end >= kPostambleLen &&
+            text_.compare(end - kPostambleLen, kPostambleLen, kPostamble) == 0 &&
+            try_frame(end)) {
+            // Everything up to and including the frame has been consumed.
+            consume(end);
+            i = 0;
+            continue;
+        }
+        ++i;
+    }
+
+    // Keep memory bounded: without a preamble only the last few characters
+    // can still become part of one.
+    std::size_t first = text_.find(kPreamble);
+    if (first == std::string::npos) {
+        if (text_.size() > kPostambleLen) {
+            consume(text_.size() - kPostambleLen);
+        }
+    } else if (first > 0) {
+        consume(first);
+    }
+    if (text_.size() > kMaxPendingChars) {
+        std::size_t next = text_.find(kPreamble, 1);
+        consume(next == std::string::npos ? text_.size() : next);
+    }
+}
+
+bool StreamingDecoder::try_frame(std::size_t end) {
+    // The payload alphabet includes ' ', 'A' and 'R', so both "KKK " and
+    // " AR" can occur inside a frame. Prefer the latest preamble (shortest
+    // span) and fall back to earlier ones; the CRC decides.
+    std::size_t start = text_.rfind(kPreamble, end);
+    while (start != std::string::npos) {
+        std::vector<Erasure> erasures;
+        for (const auto& e : erasures_) {
+            if (e.pos < start || e.pos >= end) continue;
+            erasures.push_back(e);
+            erasures.back().pos -= start;
+        }
+        DecodeResult result = pipeline_.decode_frame(text_.substr(start, end - start),
+                                                     erasures);
+        if (result.stage_reached > DecodeStage::Deframe) {
+            result.wpm = pipeline_.unit_to_wpm(
+                pipeline_.morse_decoder().unit(morse_state_));
+            if (on_frame_) on_frame_(result);
+            return true;
+        }
+        if (start == 0) break;
+        start = text_.rfind(kPreamble, start - 1);
+    }
+    return false;
+}
+
+} // namespace btccw::node
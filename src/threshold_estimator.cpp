@@ -0,0 +1,136 @@
+#include "threshold_estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace btccw::node {
+
+ThresholdEstimator::ThresholdEstimator(ThresholdMode mode) : mode_(mode) {}
+
+void ThresholdEstimator::reset() {
+    *this = ThresholdEstimator(mode_);
+}
+
+void ThresholdEstimator::add(double mag) {
+    switch (mode_) {
+        case ThresholdMode::Sort:      add_sort(mag);      break;
+        case ThresholdMode::Histogram:
+        case ThresholdMode::Adaptive:  add_histogram(mag); break;
+    }
+    ++count_;
+
+    if (mode_ != ThresholdMode::Sort && forget_ && ++since_halving_ >= kHistHalfLife) {
+        halve_histogram();
+    }
+}
+
+double ThresholdEstimator::median() const {
+    if (count_ == 0) return 0.0;
+    switch (mode_) {
+        case ThresholdMode::Sort:      return median_sort();
+        case ThresholdMode::Histogram:
+        case ThresholdMode::Adaptive:  return median_histogram();
+    }
+    return 0.0;
+}
+
+double ThresholdEstimator::median_of(const std::vector<double>& mags,
+                                     ThresholdMode mode) {
+    if (mags.empty()) return 0.0;
+
+    if (mode == ThresholdMode::Sort) {
+        // Exact: selection over the whole buffer, not just the stream window.
+        std::vector<double> sorted = mags;
+        auto mid = sorted.begin() + static_cast<std::ptrdiff_t>(sorted.size() / 2);
+        std::nth_element(sorted.begin(), mid, sorted.end());
+        return *mid;
+    }
+
+    ThresholdEstimator est(mode);
+    est.forget_ = false;   // the whole buffer, oldest blocks included
+    for (double m : mags) est.add(m);
+    return est.median();
+}
+
+// ---------------------------------------------------------------------------
+// Sort
+// ---------------------------------------------------------------------------
+
+void ThresholdEstimator::add_sort(double mag) {
+    if (history_.size() < kSortWindow) {
+        history_.push_back(mag);
+    } else {
+        history_[history_pos_] = mag;
+        history_pos_ = (history_pos_ + 1) % kSortWindow;
+    }
+}
+
+double ThresholdEstimator::median_sort() const {
+    scratch_.assign(history_.begin(), history_.end());
+    auto mid = scratch_.begin() + static_cast<std::ptrdiff_t>(scratch_.size() / 2);
+    std::nth_element(scratch_.begin(), mid, scratch_.end());
+    return *mid;
+}
+
+// ---------------------------------------------------------------------------
+// Histogram
+// ---------------------------------------------------------------------------
+
+std::size_t ThresholdEstimator::hist_bin(double mag) noexcept {
+    if (!(mag > 0.0)) return 0;
+    double pos = (std::log2(mag) - kHistMinLog2) * kHistBinsPerOctave;
+    if (pos <= 0.0) return 0;
+    if (pos >= static_cast<double>(kHistBins - 1)) return kHistBins - 1;
+    return static_cast<std::size_t>(pos);
+}
+
+double ThresholdEstimator::hist_value(double pos) noexcept {
+    return std::exp2(kHistMinLog2 + pos / kHistBinsPerOctave);
+}
+
+void ThresholdEstimator::add_histogram(double mag) {
+    const std::size_t bin = hist_bin(mag);
+    ++hist_[bin];
+    if (bin < cursor_) ++below_;
+
+    // Keep cursor_ on the bin holding sorted index (count / 2).
+    const std::size_t target = (count_ + 1) / 2;
+    while (below_ > target) {
+        --cursor_;
+        below_ -= hist_[cursor_];
+    }
+    while (below_ + hist_[cursor_] <= target) {
+        below_ += hist_[cursor_];
+        ++cursor_;
+    }
+}
+
+void ThresholdEstimator::halve_histogram() {
+    // Rounding down: rounding up would keep every bin ever hit at 1 for
+    // good, and a day of old noise floors would drag the median down.
+    count_ = 0;
+    for (auto& n : hist_) {
+        n /= 2;
+        count_ += n;
+    }
+    since_halving_ = 0;
+
+    cursor_ = 0;
+    below_  = 0;
+    if (count_ == 0) return;
+    const std::size_t target = count_ / 2;
+    while (below_ + hist_[cursor_] <= target) {
+        below_ += hist_[cursor_];
+        ++cursor_;
+    }
+}
+
+double ThresholdEstimator::median_histogram() const {
+    // Interpolate within the bin, in the log domain.
+    const std::size_t target = count_ / 2;
+    const double frac = (static_cast<double>(target - below_) + 0.5) /
+                        static_cast<double>(hist_[cursor_]);
+    return hist_value(static_cast<double>(cursor_) + frac);
+}
+
+} // namespace btccw::node
@@ -0,0 +1,137 @@
+#include "tone_synth.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "audio_io.hpp"
+
+namespace btccw::node {
+
+ToneSynth::ToneSynth(double sample_rate, double tone_freq_hz, int wpm, double rise_time_s)
+    : samples_per_unit_(static_cast<std::size_t>(sample_rate * AudioIO::unit_duration(wpm))),
+      edge_(std::min(static_cast<std::size_t>(std::max(rise_time_s, 0.0) * sample_rate),
+                     samples_per_unit_ / 2)),
+      phase_step_(static_cast<uint32_t>(
+          std::llround(tone_freq_hz / sample_rate * 4294967296.0) & 0xFFFFFFFFll)) {
+    for (std::size_t i = 0; i <= kTableSize; ++i) {
+        table_[i] = static_cast<float>(
+            std::sin(2.0 * M_PI * static_cast<double>(i) / static_cast<double>(kTableSize)));
+    }
+
+    rise_.resize(edge_);
+    for (std::size_t i = 0; i < edge_; ++i) {
+        rise_[i] = static_cast<float>(
+            0.5 - 0.5 * std::cos(M_PI * (static_cast<double>(i) + 0.5) /
+                                 static_cast<double>(edge_)));
+    }
+
+    templates_.resize(kMaxTemplateUnits + 1);
+    for (std::size_t units = 1; units <= kMaxTemplateUnits; ++units) {
+        templates_[units].resize(units * samples_per_unit_ + edge_);
+        synthesize(units, 0, templates_[units].size(), templates_[units].data());
+    }
+}
+
+void ToneSynth::synthesize(std::size_t units, std::size_t first, std::size_t count,
+                           float* out) const noexcept {
+    const std::size_t on = units * samples_per_unit_;
+    constexpr unsigned kFracBits = 32 - kTableBits;
+    constexpr float kFracScale = 1.0f / static_cast<float>(1u << kFracBits);
+
+    // The accumulator wraps mod 2^32, so the phase at `first` is a product.
+    uint32_t phase = static_cast<uint32_t>(first) * phase_step_;
+    for (std::size_t i = first; i < first + count; ++i, phase += phase_step_) {
+        // Linear interpolation between table entries.
+        const uint32_t index = phase >> kFracBits;
+        const float frac = static_cast<float>(phase & ((1u << kFracBits) - 1)) * kFracScale;
+        float s = table_[index] + (table_[index + 1] - table_[index]) * frac;
+
+        if (i < edge_)   s *= rise_[i];
+        if (i >= on)     s *= rise_[edge_ - 1 - (i - on)];
+        out[i - first] = kAmplitude * s;
+    }
+}
+
+void ToneSynth::run_samples(std::size_t units, std::size_t first, std::size_t count,
+                            float* out) const noexcept {
+    if (units <= kMaxTemplateUnits) {
+        std::memcpy(out, templates_[units].data() + first, count * sizeof(float));
+    } else {
+        synthesize(units, first, count, out);
+    }
+}
+
+std::size_t ToneSynth::length(const std::vector<int8_t>& timing) const noexcept {
+    const bool tail = !timing.empty() && timing.back() > 0;
+    return timing.size() * samples_per_unit_ + (tail ? edge_ : 0);
+}
+
+std::vector<float> ToneSynth::render(const std::vector<int8_t>& timing) const {
+    std::vector<float> pcm;
+    render(timing, pcm);
+    return pcm;
+}
+
+void ToneSynth::render(const std::vector<int8_t>& timing, std::vector<float>& pcm) const {
+    pcm.resize(length(timing));
+    Cursor cursor;
+    render_next(timing, cursor, pcm.data(), pcm.size());
+}
+
+std::size_t ToneSynth::render_next(const std::vector<int8_t>& timing, Cursor& c,
+                                   float* out, std::size_t frames) const noexcept {
+    // Each sample is written once: a template copy for a key-down run, a
+    // zero fill for a silence. A fall belongs to the run that keyed it but
+    // is played over the start of the silence after it (or after the last
+    // unit), which edge_ <= samples_per_unit_ / 2 keeps inside that silence.
+    const std::size_t n = timing.size();
+    std::size_t written = 0;
+    while (written < frames) {
+        const std::size_t want = frames - written;
+
+        if (c.unit >= n) {
+            // Trailing fall of a transmission that ends key-down.
+            if (c.fall == 0 || c.offset >= edge_) break;
+            const std::size_t take = std::min(want, edge_ - c.offset);
+            run_samples(c.fall, c.fall * samples_per_unit_ + c.offset, take, out + written);
+            c.offset += take;
+            written  += take;
+            continue;
+        }
+
+        if (c.run == 0) {
+            c.on = timing[c.unit] > 0;
+            std::size_t end = c.unit;
+            while (end < n && (timing[end] > 0) == c.on) ++end;
+            c.run = end - c.unit;
+        }
+
+        const std::size_t total = c.run * samples_per_unit_;
+        const std::size_t take  = std::min(want, total - c.offset);
+        float* dst = out + written;
+        if (c.on) {
+            run_samples(c.run, c.offset, take, dst);
+        } else {
+            std::size_t done = 0;
+            if (c.fall > 0 && c.offset < edge_) {
+                done = std::min(take, edge_ - c.offset);
+                run_samples(c.fall, c.fall * samples_per_unit_ + c.offset, done, dst);
+            }
+            std::memset(dst + done, 0, (take - done) * sizeof(float));
+        }
+        c.offset += take;
+        written  += take;
+
+        if (c.offset == total) {
+            c.fall   = c.on ? c.run : 0;
+            c.unit  += c.run;
+            c.run    = 0;
+            c.offset = 0;
+        }
+    }
+    c.samples += written;
+    return written;
+}
+
+} // namespace btccw::node
@@ -0,0 +1,211 @@
+#include "txid.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace btccw::node {
+
+// ---------------------------------------------------------------------------
+// SHA-256
+// ---------------------------------------------------------------------------
+
+static constexpr uint32_t kRound[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+void Sha256::reset() {
+    static constexpr uint32_t kInit[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    std::memcpy(state_, kInit, sizeof(state_));
+    used_  = 0;
+    total_ = 0;
+}
+
+void Sha256::compress(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = static_cast<uint32_t>(block[4 * i]) << 24 |
+               static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+               static_cast<uint32_t>(block[4 * i + 2]) << 8 |
+               static_cast<uint32_t>(block[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+        const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) +
+                            ((e & f) ^ (~e & g)) + kRound[i] + w[i];
+        const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) +
+                            ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+    state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+}
+
+void Sha256::update(const uint8_t* data, std::size_t len) {
+    total_ += len;
+    if (used_ > 0) {
+        const std::size_t take = std::min(len, sizeof(block_) - used_);
+        std::memcpy(block_ + used_, data, take);
+        used_ += take;
+        data  += take;
+        len   -= take;
+        if (used_ < sizeof(block_)) return;
+        compress(block_);
+        used_ = 0;
+    }
+    // Whole blocks straight from the input.
+    for (; len >= sizeof(block_); data += sizeof(block_), len -= sizeof(block_)) {
+        compress(data);
+    }
+    std::memcpy(block_, data, len);
+    used_ = len;
+}
+
+Sha256::Digest Sha256::finish() {
+    const uint64_t bits = total_ * 8;
+    static constexpr uint8_t kPad[64] = {0x80};
+    // 0x80, zeros up to 56 mod 64, then the bit length big-endian.
+    update(kPad, 1 + (119 - total_ % 64) % 64);
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i) length[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    update(length, sizeof(length));
+
+    Digest out;
+    for (int i = 0; i < 8; ++i) {
+        out[4 * i]     = static_cast<uint8_t>(state_[i] >> 24);
+        out[4 * i + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        out[4 * i + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        out[4 * i + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    reset();
+    return out;
+}
+
+Sha256::Digest Sha256::hash(const uint8_t* data, std::size_t len) {
+    Sha256 sha;
+    sha.update(data, len);
+    return sha.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Transaction layout
+// ---------------------------------------------------------------------------
+
+/// Bounds-checked reader over the serialized transaction.
+class TxReader {
+public:
+    explicit TxReader(const std::vector<uint8_t>& raw) : raw_(raw) {}
+
+    std::size_t pos() const noexcept { return pos_; }
+    bool        done() const noexcept { return pos_ == raw_.size(); }
+
+    bool skip(uint64_t len) {
+        if (len > raw_.size() - pos_) return false;
+        pos_ += static_cast<std::size_t>(len);
+        return true;
+    }
+
+    bool byte(uint8_t& out) {
+        if (pos_ >= raw_.size()) return false;
+        out = raw_[pos_++];
+        return true;
+    }
+
+    /// CompactSize: one byte, or 0xFD/0xFE/0xFF and 2/4/8 bytes little-endian.
+    bool varint(uint64_t& out) {
+        uint8_t first = 0;
+        if (!byte(first)) return false;
+        if (first < 0xFD) {
+            out = first;
+            return true;
+        }
+        const int width = first == 0xFD ? 2 : first == 0xFE ? 4 : 8;
+        if (static_cast<std::size_t>(width) > raw_.size() - pos_) return false;
+        out = 0;
+        for (int i = 0; i < width; ++i) out |= static_cast<uint64_t>(raw_[pos_++]) << (8 * i);
+        return true;
+    }
+
+    /// A length-prefixed byte string.
+    bool skip_bytes() {
+        uint64_t len = 0;
+        return varint(len) && skip(len);
+    }
+
+private:
+    const std::vector<uint8_t>& raw_;
+    std::size_t                 pos_ = 0;
+};
+
+bool compute_txid(const std::vector<uint8_t>& raw_tx, std::string& txid) {
+    // version | [marker 00, flag 01] | inputs | outputs | [witnesses] | locktime
+    TxReader in(raw_tx);
+    if (!in.skip(4)) return false;
+
+    const bool segwit = raw_tx.size() > 6 && raw_tx[4] == 0x00 && raw_tx[5] != 0x00;
+    if (segwit && !in.skip(2)) return false;
+    const std::size_t body_start = in.pos();
+
+    uint64_t inputs = 0;
+    if (!in.varint(inputs) || inputs == 0) return false;
+    for (uint64_t i = 0; i < inputs; ++i) {
+        // Previous outpoint (hash, index), scriptSig, sequence.
+        if (!in.skip(36) || !in.skip_bytes() || !in.skip(4)) return false;
+    }
+    uint64_t outputs = 0;
+    if (!in.varint(outputs)) return false;
+    for (uint64_t i = 0; i < outputs; ++i) {
+        // Value, scriptPubKey.
+        if (!in.skip(8) || !in.skip_bytes()) return false;
+    }
+    const std::size_t body_end = in.pos();
+
+    if (segwit) {
+        for (uint64_t i = 0; i < inputs; ++i) {
+            uint64_t items = 0;
+            if (!in.varint(items)) return false;
+            for (uint64_t k = 0; k < items; ++k) {
+                if (!in.skip_bytes()) return false;
+            }
+        }
+    }
+    const std::size_t locktime = in.pos();
+    if (!in.skip(4) || !in.done()) return false;
+
+    Sha256 sha;
+    sha.update(raw_tx.data(), 4);
+    sha.update(raw_tx.data() + body_start, body_end - body_start);
+    sha.update(raw_tx.data() + locktime, 4);
+    const Sha256::Digest once  = sha.finish();
+    const Sha256::Digest twice = Sha256::hash(once.data(), once.size());
+
+    static constexpr char kHex[] = "0123456789abcdef";
+    txid.resize(64);
+    for (std::size_t i = 0; i < 32; ++i) {
+        const uint8_t b = twice[31 - i];
+        txid[2 * i]     = kHex[b >> 4];
+        txid[2 * i + 1] = kHex[b & 0x0F];
+    }
+    return true;
+}
+
+} // namespace btccw::node
@@ -0,0 +1,64 @@
+#include "txid_cache.hpp"
+
+namespace btccw::node {
+
+void TxidCache::reset(const TxidCacheConfig& cfg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cfg_ = cfg;
+    order_.clear();
+    index_.clear();
+    hits_   = 0;
+    misses_ = 0;
+}
+
+bool TxidCache::expired(const Entry& entry, Clock::time_point now) const {
+    return cfg_.window_s > 0.0 &&
+           std::chrono::duration<double>(now - entry.added).count() >= cfg_.window_s;
+}
+
+bool TxidCache::contains(const std::string& txid, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(txid);
+    if (it == index_.end()) {
+        ++misses_;
+        return false;
+    }
+    if (expired(*it->second, now)) {
+        order_.erase(it->second);
+        index_.erase(it);
+        ++misses_;
+        return false;
+    }
+    order_.splice(order_.begin(), order_, it->second);
+    ++hits_;
+    return true;
+}
+
+void TxidCache::insert(const std::string& txid, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cfg_.capacity == 0) return;
+
+    auto it = index_.find(txid);
+    if (it != index_.end()) {
+        it->second->added = now;
+        order_.splice(order_.begin(), order_, it->second);
+        return;
+    }
+    order_.push_front(Entry{txid, now});
+    index_.emplace(txid, order_.begin());
+    while (order_.size() > cfg_.capacity) {
+        index_.erase(order_.back().txid);
+        order_.pop_back();
+    }
+}
+
+TxidCacheStats TxidCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TxidCacheStats stats;
+    stats.hits   = hits_;
+    stats.misses = misses_;
+    stats.size   = order_.size();
+    return stats;
+}
+
+} // namespace btccw::node
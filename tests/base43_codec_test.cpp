@@ -0,0 +1,132 @@
+// Differential test: Base43Codec against the core's btccw::Base43, which
+// defines the wire format. Every case must give the same text, the same
+// bytes back, and the same answer for text that is not Base43.
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <btccw/base43.hpp>
+
+#include "base43_codec.hpp"
+
+using btccw::node::Base43Codec;
+
+namespace {
+
+constexpr char kAlphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ +/.:-?";
+
+// Split points in base43_codec.cpp: 32 limbs of 4 bytes (encode) or of
+// 5 digits (decode), doubled at each level of the recursion.
+constexpr std::size_t kLeafBytes  = 32 * 4;
+constexpr std::size_t kLeafDigits = 32 * 5;
+
+std::mt19937 rng(43);
+int cases    = 0;
+int failures = 0;
+
+void fail(const char* what, std::size_t size) {
+    if (++failures <= 10) std::fprintf(stderr, "FAIL %s, size %zu\n", what, size);
+}
+
+void check_bytes(const std::vector<uint8_t>& bytes) {
+    ++cases;
+    const std::string want = btccw::Base43::encode(bytes);
+    const std::string got  = Base43Codec::encode(bytes);
+    if (got != want) return fail("encode differs from core", bytes.size());
+    if (Base43Codec::decode(got) != btccw::Base43::decode(want)) {
+        return fail("decode differs from core", bytes.size());
+    }
+    if (!bytes.empty() && Base43Codec::decode(got) != bytes) {
+        fail("decode(encode(x)) != x", bytes.size());
+    }
+}
+
+void check_text(const std::string& text) {
+    ++cases;
+    if (Base43Codec::decode(text) != btccw::Base43::decode(text)) {
+        fail("decode of text differs from core", text.size());
+    }
+}
+
+std::vector<uint8_t> random_bytes(std::size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+    return bytes;
+}
+
+std::string random_text(std::size_t size) {
+    std::string text(size, '0');
+    for (auto& c : text) c = kAlphabet[rng() % 43];
+    return text;
+}
+
+/// Sizes on and either side of every split point up to `limit`.
+std::vector<std::size_t> around_splits(std::size_t leaf, std::size_t limit) {
+    std::vector<std::size_t> sizes;
+    for (std::size_t split = leaf; split <= limit; split *= 2) {
+        for (std::size_t d : {0, 1, 2, 3, 4, 5}) {
+            sizes.push_back(split - d);
+            sizes.push_back(split + d);
+        }
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main() {
+    // Empty input.
+    check_bytes({});
+    check_text("");
+
+    // Random lengths, small to several levels of recursion.
+    for (std::size_t size = 1; size < 600; ++size) check_bytes(random_bytes(size));
+    for (int i = 0; i < 60; ++i) check_bytes(random_bytes(rng() % 6000));
+    for (std::size_t size : around_splits(kLeafBytes, 16 * kLeafBytes)) {
+        check_bytes(random_bytes(size));
+    }
+
+    // Leading zeros are kept as '0's; runs of 0x00 and 0xFF elsewhere stress
+    // carries and borrows across limbs.
+    for (std::size_t size : around_splits(kLeafBytes, 8 * kLeafBytes)) {
+        std::vector<uint8_t> bytes = random_bytes(size);
+        const std::size_t zeros = rng() % (size / 2 + 1);
+        for (std::size_t i = 0; i < zeros; ++i) bytes[i] = 0;
+        check_bytes(bytes);
+
+        check_bytes(std::vector<uint8_t>(size, 0xFF));
+        check_bytes(std::vector<uint8_t>(size, 0x00));
+
+        std::vector<uint8_t> one(size, 0);
+        one.back() = 1;
+        check_bytes(one);
+
+        std::vector<uint8_t> runs = random_bytes(size);
+        for (auto& b : runs) {
+            if (rng() % 3) b = rng() % 2 ? 0xFF : 0x00;
+        }
+        check_bytes(runs);
+    }
+
+    // Text: valid, around the decode split points, and with a character
+    // outside the alphabet.
+    for (int i = 0; i < 60; ++i) check_text(random_text(rng() % 4000));
+    for (std::size_t size : around_splits(kLeafDigits, 16 * kLeafDigits)) {
+        check_text(random_text(size));
+        check_text(std::string(size, '0'));
+        check_text(std::string(size, ':'));
+    }
+    for (const char bad : {'a', 'z', '#', '$', '\0', '\xFF'}) {
+        for (std::size_t size : {1, 2, 159, 160, 161, 1000}) {
+            std::string text = random_text(size);
+            text[rng() % size] = bad;
+            check_text(text);
+        }
+    }
+
+    std::printf("%d cases, %d failures\n", cases, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// FileDecoder: a frame longer than the chunks around it, straddling their
+// seams, must be found exactly once however the recording is split.
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <btccw/base43.hpp>
+#include <btccw/checksum.hpp>
+#include <btccw/morse.hpp>
+
+#include "file_decoder.hpp"
+#include "tone_synth.hpp"
+
+using namespace btccw::node;
+
+namespace {
+
+constexpr double kSampleRate = 8000.0;
+constexpr double kRecordingS = 895.0;
+constexpr double kFrameAtS   = 60.0;
+
+int failures = 0;
+
+/// A framed payload about 445 s long at 20 WPM. The Morse decoder reads a
+/// long gap as one space, so payloads with two in a row are skipped.
+std::string make_frame(std::string& payload) {
+    std::mt19937 rng(25);
+    for (;;) {
+        std::vector<uint8_t> bytes(372);
+        for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+        payload = btccw::Base43::encode(bytes);
+        const std::string frame = btccw::Checksum::frame(payload);
+        if (frame.find("  ") == std::string::npos) return frame;
+    }
+}
+
+void check(const std::string& path, const std::string& payload, std::size_t threads,
+           double chunk_s, double frame_end_s) {
+    FileDecodeConfig cfg;
+    cfg.threads         = threads;
+    cfg.chunk_s         = chunk_s;
+    cfg.raw.format      = SampleFormat::F32;
+    cfg.raw.sample_rate = kSampleRate;
+    const FileDecodeResult result = FileDecoder(cfg).decode(path);
+
+    int found = 0;
+    for (const auto& frame : result.frames) {
+        if (frame.result.base43_payload != payload) continue;
+        ++found;
+        if (frame.offset_s < frame_end_s - 2.0 || frame.offset_s > frame_end_s + 2.0) {
+            std::fprintf(stderr, "FAIL %zu chunk(s): frame at %.1f s, ends at %.1f s\n",
+                         result.chunks, frame.offset_s, frame_end_s);
+            ++failures;
+        }
+    }
+    std::printf("%zu thread(s), %zu chunk(s): found %d time(s)\n", threads, result.chunks,
+                found);
+    if (found != 1) {
+        std::fprintf(stderr, "FAIL %zu chunk(s): frame found %d times\n", result.chunks, found);
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    std::string payload;
+    const std::string frame = make_frame(payload);
+
+    std::vector<float> pcm(static_cast<std::size_t>(kFrameAtS * kSampleRate), 0.0f);
+    const std::vector<float> keyed =
+        ToneSynth(kSampleRate, 750.0, 20, 0.005).render(btccw::MorseEncoder::encode(frame));
+    pcm.insert(pcm.end(), keyed.begin(), keyed.end());
+    const double frame_end_s = static_cast<double>(pcm.size()) / kSampleRate;
+    pcm.resize(static_cast<std::size_t>(kRecordingS * kSampleRate), 0.0f);
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    for (auto& s : pcm) s += noise(rng);
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "btccw_file_decoder_test.f32").string();
+    if (FILE* f = std::fopen(path.c_str(), "wb")) {
+        std::fwrite(pcm.data(), sizeof(float), pcm.size(), f);
+        std::fclose(f);
+    } else {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("frame of %zu characters, %.0f-%.0f s of %.0f s\n", frame.size(), kFrameAtS,
+                frame_end_s, kRecordingS);
+
+    check(path, payload, 1, 0.0, frame_end_s);     // whole
+    check(path, payload, 2, 400.0, frame_end_s);   // one seam inside the frame
+    check(path, payload, 2, 0.0, frame_end_s);     // the default split, four per thread
+    check(path, payload, 2, 120.0, frame_end_s);   // the frame spans several chunks
+
+    std::filesystem::remove(path);
+    return failures == 0 ? 0 : 1;
+}
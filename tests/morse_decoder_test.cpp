@@ -0,0 +1,91 @@
+// MorseDecoder speed estimate: a sender at the slowest speed followed
+// (kMaxSpeedRatio below the configured WPM) must decode at every hop, down
+// to hops so small that a dash spans hundreds of blocks.
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <btccw/morse.hpp>
+
+#include "morse_decoder.hpp"
+#include "tone_bits.hpp"
+
+using btccw::node::MorseDecoder;
+using btccw::node::ToneBits;
+
+namespace {
+
+constexpr double kSampleRate = 44100.0;
+constexpr int    kWpm        = 20;
+constexpr char   kText[]     = "KKK 0123456789 ABCDEFGHIJKLM NOPQRSTUVWXYZ +/.:-? AR";
+
+int failures = 0;
+
+/// Tone decisions for `text` keyed at `blocks` per unit. The detector's
+/// hysteresis lengthens key-down runs by a block and shortens gaps to match.
+ToneBits key(const std::string& text, int blocks) {
+    ToneBits tones;
+    for (int i = 0; i < 2 * blocks; ++i) tones.push_back(false);
+    bool on = false;
+    int  run = 0;
+    auto end_run = [&] {
+        const int length = run + (on ? 1 : -1);
+        for (int i = 0; i < length; ++i) tones.push_back(on);
+        run = 0;
+    };
+    for (int8_t unit : btccw::MorseEncoder::encode(text)) {
+        if ((unit > 0) != on && run > 0) end_run();
+        on = unit > 0;
+        run += blocks;
+    }
+    end_run();
+    for (int i = 0; i < 10 * blocks; ++i) tones.push_back(false);
+    return tones;
+}
+
+std::string trim(std::string s) {
+    while (!s.empty() && s.back() == ' ') s.pop_back();
+    return s;
+}
+
+void check(std::size_t hop) {
+    // The unit the pipeline configures, and the sender kMaxSpeedRatio slower.
+    const int configured = static_cast<int>(std::round(1.2 / kWpm * kSampleRate / hop));
+    const int slowest    = static_cast<int>(configured * MorseDecoder::kMaxSpeedRatio);
+    const MorseDecoder decoder(configured, true);
+    const ToneBits tones = key(kText, slowest);
+
+    double unit = 0.0;
+    const std::string batch = trim(decoder.decode(tones, &unit));
+
+    MorseDecoder::StreamState st;
+    std::string streamed;
+    bool on = tones[0];
+    for (std::size_t i = 0; i < tones.size(); on = !on) {
+        const std::size_t end = tones.find_next(i, !on);
+        decoder.push_run(st, on, static_cast<int>(end - i), streamed);
+        i = end;
+    }
+    decoder.flush(st, streamed);
+    streamed = trim(streamed);
+
+    std::printf("hop %4zu: %3d blocks per unit configured, sender at %4d, estimate %.1f\n",
+                hop, configured, slowest, unit);
+    if (batch != kText) {
+        std::fprintf(stderr, "FAIL hop %zu decode(): \"%s\"\n", hop, batch.c_str());
+        ++failures;
+    }
+    if (streamed != kText) {
+        std::fprintf(stderr, "FAIL hop %zu push_run(): \"%s\"\n", hop, streamed.c_str());
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t hop : {882, 441, 220, 110, 44, 22}) check(hop);
+    return failures == 0 ? 0 : 1;
+}
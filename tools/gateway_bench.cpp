@@ -0,0 +1,152 @@
+// Gateway throughput against a local endpoint (tools/http_standin.py).
+//
+//   gateway-bench <url> [count [in_flight]]
+//
+// Sends `count` transactions three ways: a fresh curl handle and
+// connection per request (the gateway before pooling), one at a time
+// through the gateway, and all at once through the gateway with up to
+// `in_flight` running. A URL ending in /api/tx is treated as
+// mempool.space; any other as Bitcoin Core's RPC, where the first way is
+// replaced by one JSON-RPC batch.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "gateway.hpp"
+
+using btccw::node::BroadcastBackend;
+using btccw::node::BroadcastResult;
+using btccw::node::Gateway;
+using btccw::node::GatewayConfig;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool ends_with(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/// A distinct body per request; the stand-in does not validate it.
+std::string fake_tx(int run, int i) {
+    char hex[32];
+    std::snprintf(hex, sizeof hex, "%02x%08x", run, i);
+    return hex;
+}
+
+std::size_t append(char* data, std::size_t size, std::size_t count, void* out) {
+    static_cast<std::string*>(out)->append(data, size * count);
+    return size * count;
+}
+
+/// One mempool.space-style POST on a new handle, as before pooling.
+bool post_unpooled(const std::string& url, const std::string& body) {
+    CURL* curl = curl_easy_init();
+    std::string response;
+    curl_slist* headers = curl_slist_append(nullptr, "Content-Type: text/plain");
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    long status = 0;
+    const bool ok = curl_easy_perform(curl) == CURLE_OK &&
+                    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status) == CURLE_OK &&
+                    status == 200;
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return ok;
+}
+
+void report(const char* what, int ok, int count, double seconds) {
+    std::printf("%-22s %5d/%d in %7.3f s  %8.0f tx/s\n", what, ok, count, seconds,
+                count / seconds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: gateway-bench <url> [count [in_flight]]\n");
+        return 2;
+    }
+    const std::string url = argv[1];
+    const int count       = argc > 2 ? std::atoi(argv[2]) : 500;
+    const int in_flight   = argc > 3 ? std::atoi(argv[3]) : 8;
+    const bool mempool    = ends_with(url, "/api/tx");
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    if (mempool) {
+        const auto start = Clock::now();
+        int ok = 0;
+        for (int i = 0; i < count; ++i) ok += post_unpooled(url, fake_tx(0, i));
+        report("new handle per request", ok, count, since(start));
+    }
+
+    GatewayConfig cfg;
+    if (mempool) {
+        cfg.mempool_url = url;
+    } else {
+        btccw::node::BroadcastEndpoint rpc;
+        rpc.backend = BroadcastBackend::BitcoinRPC;
+        rpc.url     = url;
+        cfg.endpoints.push_back(rpc);
+    }
+    cfg.max_in_flight = static_cast<std::size_t>(std::max(in_flight, 1));
+    cfg.queue_depth   = static_cast<std::size_t>(count) + 1;
+
+    Gateway gateway;
+    if (!gateway.open(cfg)) {
+        std::fprintf(stderr, "gateway did not open\n");
+        return 1;
+    }
+
+    {
+        const auto start = Clock::now();
+        int ok = 0;
+        for (int i = 0; i < count; ++i) ok += !gateway.broadcast(fake_tx(1, i)).empty();
+        report("pooled, one at a time", ok, count, since(start));
+    }
+    {
+        const auto start = Clock::now();
+        std::vector<std::future<BroadcastResult>> pending;
+        for (int i = 0; i < count; ++i) pending.push_back(gateway.broadcast_async(fake_tx(2, i)));
+        int ok = 0;
+        for (auto& result : pending) ok += result.get().success;
+        char what[32];
+        std::snprintf(what, sizeof what, "pooled, %d in flight", in_flight);
+        report(what, ok, count, since(start));
+    }
+
+    if (!mempool) {
+        std::vector<std::string> txs;
+        for (int i = 0; i < count; ++i) txs.push_back(fake_tx(3, i));
+        const auto start = Clock::now();
+        int ok = 0;
+        for (const auto& result : gateway.broadcast_batch({txs.begin(), txs.end()})) {
+            ok += result.success;
+        }
+        report("pooled, RPC batches", ok, count, since(start));
+    }
+
+    const auto stats = gateway.stats();
+    std::printf("retries %llu, mean latency %.1f ms, max %.1f ms\n",
+                static_cast<unsigned long long>(stats.retries), stats.mean_latency_s * 1e3,
+                stats.max_latency_s * 1e3);
+    gateway.close();
+    curl_global_cleanup();
+    return 0;
+}
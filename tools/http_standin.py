@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Local stand-in for a broadcast endpoint, for benchmarking the gateway.
+
+Answers like mempool.space (POST /api/tx, the raw hex as the body) and
+like Bitcoin Core's JSON-RPC sendrawtransaction (a JSON body, single or
+batch), on 127.0.0.1 over keep-alive HTTP/1.1.
+
+    tools/http_standin.py PORT [--delay S] [--lose N]
+
+--delay S  sleep S seconds before each answer (server latency)
+--lose N   take each transaction, then answer its first N requests with
+           HTTP 503 as if the reply were lost; later requests are told the
+           transaction is already known
+
+GET /stats returns "<connections> <requests>", so a client can tell
+whether it reused its connections.
+"""
+
+import argparse
+import hashlib
+import json
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+lock = threading.Lock()
+connections = 0
+requests = 0
+accepted = {}   # raw hex -> requests seen
+
+
+def txid(raw_hex):
+    """Bitcoin txid of a legacy transaction; any other body gets a stable id."""
+    try:
+        data = bytes.fromhex(raw_hex)
+    except ValueError:
+        return hashlib.sha256(raw_hex.encode()).hexdigest()
+    return hashlib.sha256(hashlib.sha256(data).digest()).digest()[::-1].hex()
+
+
+def take(raw_hex, lose):
+    """Record a request for raw_hex: 'ok', 'lost' or 'known'."""
+    with lock:
+        seen = accepted.get(raw_hex, 0)
+        accepted[raw_hex] = seen + 1
+    if seen < lose:
+        return "lost"
+    return "known" if lose and seen else "ok"
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def setup(self):
+        global connections
+        super().setup()
+        with lock:
+            connections += 1
+
+    def reply(self, code, text):
+        body = text.encode()
+        # Headers and body in one write: two small segments stall on Nagle
+        # and delayed ACK, which would swamp what is being measured.
+        head = "HTTP/1.1 %d X\r\nContent-Length: %d\r\n\r\n" % (code, len(body))
+        self.wfile.write(head.encode() + body)
+        self.wfile.flush()
+
+    def do_GET(self):
+        self.reply(200, "%d %d" % (connections, requests))
+
+    def do_POST(self):
+        global requests
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0))).decode()
+        with lock:
+            requests += 1
+        if args.delay:
+            threading.Event().wait(args.delay)
+
+        if body[:1] in "{[":
+            self.rpc(json.loads(body))
+            return
+
+        raw = body.strip()
+        state = take(raw, args.lose)
+        if state == "lost":
+            self.reply(503, "lost")
+        elif state == "known":
+            self.reply(400, 'sendrawtransaction RPC error: '
+                            '{"code":-26,"message":"txn-already-known"}')
+        else:
+            self.reply(200, txid(raw))
+
+    def rpc(self, doc):
+        calls = doc if isinstance(doc, list) else [doc]
+        raws = [call["params"][0] for call in calls]
+        states = [take(raw, args.lose) for raw in raws]
+        if "lost" in states:
+            self.reply(503, "lost")
+            return
+
+        def answer(call, raw, state):
+            if state == "known":
+                error = {"code": -26, "message": "txn-already-known"}
+                return {"result": None, "error": error, "id": call.get("id")}
+            return {"result": txid(raw), "error": None, "id": call.get("id")}
+
+        replies = [answer(*c) for c in zip(calls, raws, states)]
+        if isinstance(doc, list):
+            self.reply(200, json.dumps(replies))
+        else:
+            self.reply(500 if replies[0]["error"] else 200, json.dumps(replies[0]))
+
+    def log_message(self, *_):
+        pass
+
+
+parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+parser.add_argument("port", type=int)
+parser.add_argument("--delay", type=float, default=0.0)
+parser.add_argument("--lose", type=int, default=0)
+args = parser.parse_args()
+
+ThreadingHTTPServer.daemon_threads = True
+ThreadingHTTPServer.request_queue_size = 128
+ThreadingHTTPServer(("127.0.0.1", args.port), Handler).serve_forever()